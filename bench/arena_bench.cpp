@@ -0,0 +1,126 @@
+/**
+ * arena_bench.cpp
+ *
+ * Counts the trips to operator new made by the big-integer algorithms and
+ * times them.  The square-and-multiply loop of modexp is run twice, on the
+ * heap and inside a ScopedBlockArena, to show what the arena saves; gcd,
+ * extendedEuclidean and modexp themselves open their own arenas.
+ *
+ * usage: arena_bench [blocks]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "BigIntegerAlgorithms.hh"
+#include "BlockArena.hh"
+
+namespace {
+	unsigned long long state = 88172645463325252ULL;
+
+	unsigned long randomBlock()
+	{
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		return (unsigned long)state;
+	}
+
+	BigUnsigned randomNumber(unsigned int blocks)
+	{
+		unsigned long *b = new unsigned long[blocks];
+		for (unsigned int i = 0; i < blocks; i++)
+		{
+			b[i] = randomBlock();
+		}
+		b[blocks - 1] |= 1;
+		BigUnsigned x(b, blocks);
+		delete [] b;
+		return x;
+	}
+
+	//modexp's loop, allocating from wherever BlockMemory currently points
+	BigUnsigned powerLoop(const BigUnsigned &base, const BigUnsigned &exponent,
+		const BigUnsigned &modulus
+	) {
+		BigUnsigned ans = 1;
+		for (BigUnsigned::Index i = exponent.bitLength(); i > 0; i--)
+		{
+			ans *= ans;
+			ans %= modulus;
+			if (exponent.getBit(i - 1))
+			{
+				ans *= base;
+				ans %= modulus;
+			}
+		}
+		return ans;
+	}
+
+	std::chrono::steady_clock::time_point start;
+
+	void begin()
+	{
+		BlockMemory::resetCounts();
+		start = std::chrono::steady_clock::now();
+	}
+
+	void report(const char *name)
+	{
+		double ms = std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - start).count();
+		BlockMemory::Counts counts = BlockMemory::counts();
+		printf("%-22s %10.2f %12lu %12lu %12lu %12lu\n", name, ms,
+			counts.heapArrays + counts.arenaChunks, counts.heapArrays,
+			counts.arenaArrays, counts.arenaChunks);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int blocks = (argc > 1) ? atoi(argv[1]) : 16;
+	BigUnsigned modulus = randomNumber(blocks);
+	BigUnsigned base = randomNumber(blocks) % modulus;
+	BigUnsigned exponent = randomNumber(blocks);
+
+	printf("%u-block operands\n", blocks);
+	printf("%-22s %10s %12s %12s %12s %12s\n", "", "ms", "operator new",
+		"heap arrays", "arena arrays", "arena chunks");
+
+	begin();
+	BigUnsigned onHeap = powerLoop(base, exponent, modulus);
+	report("power loop, heap");
+
+	begin();
+	BigUnsigned inArena;
+	{
+		ScopedBlockArena arena;
+		BigUnsigned result = powerLoop(base, exponent, modulus);
+		arena.close();
+		inArena = result;
+	}
+	report("power loop, arena");
+
+	begin();
+	BigUnsigned library = modexp(base, exponent, modulus);
+	report("modexp");
+
+	begin();
+	BigUnsigned divisor = gcd(modulus * base, modulus * exponent);
+	report("gcd");
+
+	begin();
+	BigInteger g, r, s;
+	extendedEuclidean(modulus, base, g, r, s);
+	report("extendedEuclidean");
+
+	if (!(onHeap == inArena && inArena == library)
+		|| !(r * BigInteger(modulus) + s * BigInteger(base) == g)
+		|| !(divisor % modulus).isZero())
+	{
+		printf("results disagree\n");
+		return 1;
+	}
+	return 0;
+}
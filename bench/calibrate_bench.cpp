@@ -0,0 +1,175 @@
+/**
+ * calibrate_bench.cpp
+ *
+ * Measures where each BigUnsigned multiplication method starts to beat the
+ * one below it on this machine, on one thread: Karatsuba over schoolbook,
+ * Toom-3 over Karatsuba (for products and for squares), and the transforms
+ * over Toom-3.  For each size it times a single split of the faster method
+ * on top of the slower one against the slower one alone; the threshold is
+ * the first size from which the split wins three sizes running, so that
+ * one lucky timing does not place it.  Each threshold found is in use while
+ * the next is measured.
+ *
+ * The results go to stdout and, given a file name, into a CMake script
+ * setting the cache variables that BigUnsignedThresholds.hh is generated
+ * from.  The calibrate target runs it that way and reconfigures:
+ *     cmake --build . --target calibrate && cmake --build .
+ *
+ * usage: calibrate_bench [output.cmake]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "BigUnsigned.hh"
+#include "BigUnsignedKernels.hh"
+
+namespace {
+	typedef BigUnsignedKernels::Index Index;
+
+	const Index NEVER = ~0U;
+
+	//how many sizes running the split must win
+	const int CONFIRM = 3;
+
+	unsigned long long state = 88172645463325252ULL;
+
+	unsigned long randomBlock()
+	{
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		return (unsigned long)state;
+	}
+
+	BigUnsigned randomNumber(unsigned int blocks)
+	{
+		unsigned long *b = new unsigned long[blocks];
+		for (unsigned int i = 0; i < blocks; i++)
+		{
+			b[i] = randomBlock();
+		}
+		b[blocks - 1] |= 1;
+		BigUnsigned x(b, blocks);
+		delete [] b;
+		return x;
+	}
+
+	//nanoseconds per product (a * a when square is set) with threshold set
+	//to the given value, repeating for at least ~20 ms
+	double timeProduct(const BigUnsigned &a, const BigUnsigned &b, bool square,
+		Index &threshold, Index value
+	) {
+		threshold = value;
+		BigUnsigned c;
+		long reps = 0;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		double elapsed = 0;
+		do
+		{
+			if (square)
+			{
+				c.square(a);
+			}
+			else
+			{
+				c.multiply(a, b);
+			}
+			reps++;
+			elapsed = std::chrono::duration<double>(
+				std::chrono::steady_clock::now() - start).count();
+		} while (elapsed < 0.02);
+		return elapsed / reps * 1e9;
+	}
+
+	//scans sizes from first to last for the crossover of threshold and
+	//leaves threshold set to it, or to its old value if there is none
+	Index calibrate(const char *name, Index &threshold, bool square,
+		unsigned int first, unsigned int last, unsigned int step
+	) {
+		Index original = threshold, crossover = 0;
+		int wins = 0;
+		printf("\n%s\n%8s %14s %14s %8s\n", name, "blocks", "below ns",
+			"split ns", "ratio");
+		for (unsigned int n = first; n <= last && wins < CONFIRM;
+			n += (step != 0) ? step : n / 4)
+		{
+			BigUnsigned a = randomNumber(n), b = randomNumber(n);
+			double below = timeProduct(a, b, square, threshold, NEVER);
+			double split = timeProduct(a, b, square, threshold, n);
+			printf("%8u %14.0f %14.0f %8.2f\n", n, below, split, below / split);
+			if (split < below)
+			{
+				if (wins++ == 0)
+				{
+					crossover = n;
+				}
+			}
+			else
+			{
+				wins = 0;
+			}
+		}
+		threshold = (wins == CONFIRM) ? crossover : original;
+		printf("%s: %u%s\n", name, threshold,
+			(wins == CONFIRM) ? "" : " (no crossover, kept)");
+		return threshold;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	using namespace BigUnsignedKernels;
+	multiplyThreads = 1;
+
+	//the transforms stay out of the way of the lower tiers
+#ifdef BIGUNSIGNED_HAVE_NTT
+	Index ntt = nttThreshold;
+	nttThreshold = NEVER;
+#endif
+	Index toom3 = toom3Threshold, toom3Square = toom3SquareThreshold;
+	toom3Threshold = toom3SquareThreshold = NEVER;
+	Index karatsuba = calibrate("BIGUNSIGNED_KARATSUBA_THRESHOLD",
+		karatsubaThreshold, false, 4, 128, 4);
+	Index karatsubaSquare = calibrate("BIGUNSIGNED_KARATSUBA_SQUARE_THRESHOLD",
+		karatsubaSquareThreshold, true, 4, 160, 4);
+	toom3Threshold = toom3;
+	toom3SquareThreshold = toom3Square;
+	toom3 = calibrate("BIGUNSIGNED_TOOM3_THRESHOLD", toom3Threshold, false,
+		32, 1024, 0);
+	toom3Square = calibrate("BIGUNSIGNED_TOOM3_SQUARE_THRESHOLD",
+		toom3SquareThreshold, true, 32, 1024, 0);
+#ifdef BIGUNSIGNED_HAVE_NTT
+	nttThreshold = ntt;
+	ntt = calibrate("BIGUNSIGNED_NTT_THRESHOLD", nttThreshold, false,
+		1024, 32768, 0);
+#endif
+
+	if (argc > 1)
+	{
+		FILE *out = fopen(argv[1], "w");
+		if (out == NULL)
+		{
+			perror(argv[1]);
+			return 1;
+		}
+		const char *format = "set(%s %u CACHE STRING \"%s\" FORCE)\n";
+		fprintf(out, "#written by calibrate_bench\n");
+		fprintf(out, format, "BIGUNSIGNED_KARATSUBA_THRESHOLD", karatsuba,
+			"Blocks from which BigUnsigned multiplies by Karatsuba's method");
+		fprintf(out, format, "BIGUNSIGNED_KARATSUBA_SQUARE_THRESHOLD",
+			karatsubaSquare,
+			"Blocks from which BigUnsigned squares by Karatsuba's method");
+		fprintf(out, format, "BIGUNSIGNED_TOOM3_THRESHOLD", toom3,
+			"Blocks from which BigUnsigned multiplies by Toom-3");
+		fprintf(out, format, "BIGUNSIGNED_TOOM3_SQUARE_THRESHOLD", toom3Square,
+			"Blocks from which BigUnsigned squares by Toom-3");
+#ifdef BIGUNSIGNED_HAVE_NTT
+		fprintf(out, format, "BIGUNSIGNED_NTT_THRESHOLD", ntt,
+			"Blocks from which BigUnsigned multiplies by transforms");
+#endif
+		fclose(out);
+	}
+	return 0;
+}
@@ -0,0 +1,111 @@
+/**
+ * divisor_bench.cpp
+ *
+ * Times the division of a random 2n-block number by a random n-block one
+ * with divideWithRemainder by the BigUnsigned (long division) and by a
+ * BigUnsignedDivisor using Barrett's method, and the reciprocal that the
+ * BigUnsignedDivisor works out beforehand, by long division and by Newton's
+ * iteration.  The first size from which Barrett's method wins is where
+ * BigUnsignedDivisor::barrettThreshold belongs, and likewise Newton's
+ * iteration and newtonThreshold.
+ *
+ * usage: divisor_bench [maxBlocks]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "BigUnsigned.hh"
+#include "BigUnsignedDivisor.hh"
+
+namespace {
+	const BigUnsignedDivisor::Index NEVER = ~0U;
+
+	unsigned long long state = 88172645463325252ULL;
+
+	unsigned long randomBlock()
+	{
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		return (unsigned long)state;
+	}
+
+	BigUnsigned randomNumber(unsigned int blocks)
+	{
+		unsigned long *b = new unsigned long[blocks];
+		for (unsigned int i = 0; i < blocks; i++)
+		{
+			b[i] = randomBlock();
+		}
+		b[blocks - 1] |= 1;
+		BigUnsigned x(b, blocks);
+		delete [] b;
+		return x;
+	}
+
+	//microseconds per call of f, repeated until about 20ms have passed
+	template <class F>
+	double timeCall(F f)
+	{
+		long reps = 0;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		double elapsed;
+		do
+		{
+			f();
+			reps++;
+			elapsed = std::chrono::duration<double, std::micro>(
+				std::chrono::steady_clock::now() - start).count();
+		} while (elapsed < 2e4);
+		return elapsed / reps;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int maxBlocks = (argc > 1) ? atoi(argv[1]) : 4096;
+	BigUnsignedDivisor::Index originalBarrett = BigUnsignedDivisor::barrettThreshold;
+	BigUnsignedDivisor::Index originalNewton = BigUnsignedDivisor::newtonThreshold;
+
+	printf("%8s %12s %12s %8s %12s %12s %8s\n", "blocks", "divide us",
+		"barrett us", "ratio", "reciprocal", "newton us", "ratio");
+	unsigned int barrettCrossover = 0, newtonCrossover = 0;
+	for (unsigned int n = 16; n <= maxBlocks; n += n / 4)
+	{
+		BigUnsigned d = randomNumber(n), x = randomNumber(2 * n);
+		BigUnsignedDivisor::barrettThreshold = 0;
+		BigUnsignedDivisor divisor(d);
+		BigUnsigned r1, q1, r2, q2;
+
+		double divide = timeCall([&]() { r1 = x; r1.divideWithRemainder(d, q1); });
+		double barrett = timeCall([&]() { r2 = x; r2.divideWithRemainder(divisor, q2); });
+		BigUnsignedDivisor::newtonThreshold = NEVER;
+		double reciprocal = timeCall([&]() { BigUnsignedDivisor::reciprocalOf(d); });
+		BigUnsignedDivisor::newtonThreshold = 8;
+		double newton = timeCall([&]() { BigUnsignedDivisor::reciprocalOf(d); });
+
+		printf("%8u %12.1f %12.1f %8.2f %12.1f %12.1f %8.2f\n", n, divide,
+			barrett, divide / barrett, reciprocal, newton, reciprocal / newton);
+		if (!(r1 == r2) || !(q1 == q2))
+		{
+			printf("results disagree\n");
+			return 1;
+		}
+		if (barrettCrossover == 0 && barrett < divide)
+		{
+			barrettCrossover = n;
+		}
+		if (newtonCrossover == 0 && newton < reciprocal)
+		{
+			newtonCrossover = n;
+		}
+	}
+	printf("barrett first wins at %u blocks, newton at %u "
+		"(thresholds in use: %u, %u)\n", barrettCrossover, newtonCrossover,
+		originalBarrett, originalNewton);
+	BigUnsignedDivisor::barrettThreshold = originalBarrett;
+	BigUnsignedDivisor::newtonThreshold = originalNewton;
+	return 0;
+}
@@ -0,0 +1,90 @@
+/**
+ * expression_bench.cpp
+ *
+ * Times two BigInteger expressions written with the ordinary operators and
+ * with fused (BigIntegerExpression.hh), on random signed n-block operands:
+ * r = a*b + c*d - e, and r = a*x + b*y for longs x and y (the update of the
+ * Lehmer steps in modinv).
+ *
+ * usage: expression_bench [maxBlocks]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "BigIntegerExpression.hh"
+
+namespace {
+	unsigned long long state = 88172645463325252ULL;
+
+	unsigned long randomBlock()
+	{
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		return (unsigned long)state;
+	}
+
+	BigInteger randomNumber(unsigned int blocks)
+	{
+		unsigned long *b = new unsigned long[blocks];
+		for (unsigned int i = 0; i < blocks; i++)
+		{
+			b[i] = randomBlock();
+		}
+		b[blocks - 1] |= 1;
+		BigInteger x(b, blocks,
+			(randomBlock() & 1) ? BigInteger::positive : BigInteger::negative);
+		delete [] b;
+		return x;
+	}
+
+	//nanoseconds per call of f, repeated until about 20ms have passed
+	template <class F>
+	double timeCall(F f)
+	{
+		long reps = 0;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		double elapsed;
+		do
+		{
+			f();
+			reps++;
+			elapsed = std::chrono::duration<double, std::nano>(
+				std::chrono::steady_clock::now() - start).count();
+		} while (elapsed < 2e7);
+		return elapsed / reps;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int maxBlocks = (argc > 1) ? atoi(argv[1]) : 1024;
+
+	printf("%8s %12s %12s %8s %12s %12s %8s\n", "blocks",
+		"ab+cd-e ns", "fused ns", "ratio", "ax+by ns", "fused ns", "ratio");
+	for (unsigned int n = 2; n <= maxBlocks; n *= 2)
+	{
+		BigInteger a = randomNumber(n), b = randomNumber(n);
+		BigInteger c = randomNumber(n), d = randomNumber(n);
+		BigInteger e = randomNumber(2 * n);
+		long x = long(randomBlock() >> 2), y = -long(randomBlock() >> 2);
+		BigInteger r1, r2, r3, r4;
+
+		double plain = timeCall([&]() { r1 = a * b + c * d - e; });
+		double fusedProducts = timeCall([&]() { r2 = fused(a) * b + fused(c) * d - e; });
+		double plainWords = timeCall([&]() { r3 = BigInteger(x) * a + BigInteger(y) * b; });
+		double fusedWords = timeCall([&]() { r4 = fused(a) * x + fused(b) * y; });
+
+		printf("%8u %12.0f %12.0f %8.2f %12.0f %12.0f %8.2f\n", n,
+			plain, fusedProducts, plain / fusedProducts,
+			plainWords, fusedWords, plainWords / fusedWords);
+		if (!(r1 == r2) || !(r3 == r4))
+		{
+			printf("results disagree\n");
+			return 1;
+		}
+	}
+	return 0;
+}
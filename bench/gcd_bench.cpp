@@ -0,0 +1,131 @@
+/**
+ * gcd_bench.cpp
+ *
+ * Times gcd (Lehmer) and binaryGcd against Euclid's algorithm with a full
+ * BigUnsigned division per step, and modinv against the inverse taken from
+ * extendedEuclidean, on random n-block operands.
+ *
+ * usage: gcd_bench [maxBlocks]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "BigIntegerAlgorithms.hh"
+
+namespace {
+	unsigned long long state = 88172645463325252ULL;
+
+	unsigned long randomBlock()
+	{
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		return (unsigned long)state;
+	}
+
+	BigUnsigned randomNumber(unsigned int blocks)
+	{
+		unsigned long *b = new unsigned long[blocks];
+		for (unsigned int i = 0; i < blocks; i++)
+		{
+			b[i] = randomBlock();
+		}
+		b[blocks - 1] |= 1;
+		BigUnsigned x(b, blocks);
+		delete [] b;
+		return x;
+	}
+
+	//the division-per-step gcd this replaces
+	BigUnsigned euclidGcd(BigUnsigned a, BigUnsigned b)
+	{
+		BigUnsigned trash;
+		for (;;)
+		{
+			if (b.isZero())
+			{
+				return a;
+			}
+			a.divideWithRemainder(b, trash);
+			if (a.isZero())
+			{
+				return b;
+			}
+			b.divideWithRemainder(a, trash);
+		}
+	}
+
+	BigUnsigned euclidModinv(const BigUnsigned &x, const BigUnsigned &n)
+	{
+		BigInteger g, r, s;
+		extendedEuclidean(x, n, g, r, s);
+		return (r % n).getMagnitude();
+	}
+
+	typedef BigUnsigned (*Binary)(const BigUnsigned &, const BigUnsigned &);
+
+	BigUnsigned euclidGcdByReference(const BigUnsigned &a, const BigUnsigned &b)
+	{
+		return euclidGcd(a, b);
+	}
+
+	//microseconds per call, repeating for at least ~20 ms
+	double timeCall(Binary f, const BigUnsigned &a, const BigUnsigned &b,
+		BigUnsigned &result
+	) {
+		long reps = 0;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		double elapsed = 0;
+		do
+		{
+			result = f(a, b);
+			reps++;
+			elapsed = std::chrono::duration<double>(
+				std::chrono::steady_clock::now() - start).count();
+		} while (elapsed < 0.02);
+		return elapsed / reps * 1e6;
+	}
+
+	BigUnsigned modinvUnsigned(const BigUnsigned &x, const BigUnsigned &n)
+	{
+		return modinv(x, n);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int maxBlocks = (argc > 1) ? atoi(argv[1]) : 128;
+
+	printf("%8s %12s %12s %12s %14s %14s\n", "blocks", "euclid us",
+		"binary us", "lehmer us", "ext-euclid us", "modinv us");
+	for (unsigned int n = 1; n <= maxBlocks; n *= 2)
+	{
+		BigUnsigned a = randomNumber(n), b = randomNumber(n);
+		BigUnsigned r1, r2, r3, i1, i2;
+		double euclid = timeCall(euclidGcdByReference, a, b, r1);
+		double binary = timeCall(binaryGcd, a, b, r2);
+		double lehmer = timeCall(gcd, a, b, r3);
+
+		//an odd modulus with an invertible x
+		BigUnsigned modulus = a;
+		modulus.setBit(0, true);
+		BigUnsigned x = b % modulus;
+		while (!(gcd(x, modulus) == 1))
+		{
+			x++;
+		}
+		double extended = timeCall(euclidModinv, x, modulus, i1);
+		double inverse = timeCall(modinvUnsigned, x, modulus, i2);
+
+		printf("%8u %12.2f %12.2f %12.2f %14.2f %14.2f\n", n, euclid, binary,
+			lehmer, extended, inverse);
+		if (!(r1 == r2 && r2 == r3 && i1 == i2))
+		{
+			printf("results disagree\n");
+			return 1;
+		}
+	}
+	return 0;
+}
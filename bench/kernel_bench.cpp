@@ -0,0 +1,141 @@
+/**
+ * kernel_bench.cpp
+ *
+ * Times the block-array kernels behind BigUnsigned addition, subtraction and
+ * bit shifts on n-block operands: addN and subN against the portable
+ * compare-for-carry loops (addNGeneric, subNGeneric), and shiftLeftBits and
+ * shiftRightBits with the AVX2 versions switched off and on.  The AVX2
+ * versions only take over from 16 blocks up, and the vector columns repeat
+ * the portable ones on processors without AVX2.
+ *
+ * usage: kernel_bench [maxBlocks]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "BigUnsignedKernels.hh"
+
+namespace {
+	typedef BigUnsignedKernels::Blk Blk;
+	typedef BigUnsignedKernels::Index Index;
+
+	unsigned long long state = 88172645463325252ULL;
+
+	Blk randomBlock()
+	{
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		return (Blk)state;
+	}
+
+	struct Operands
+	{
+		std::vector<Blk> a, b, r;
+		Index n;
+	};
+
+	//keeps the compiler from dropping the kernel results
+	volatile Blk sink;
+
+	typedef void (*Kernel)(Operands &);
+
+	void addGeneric(Operands &x)
+	{
+		sink = BigUnsignedKernels::addNGeneric(&x.r[0], &x.a[0], &x.b[0], x.n);
+	}
+
+	void addCarry(Operands &x)
+	{
+		sink = BigUnsignedKernels::addN(&x.r[0], &x.a[0], &x.b[0], x.n);
+	}
+
+	void subGeneric(Operands &x)
+	{
+		sink = BigUnsignedKernels::subNGeneric(&x.r[0], &x.a[0], &x.b[0], x.n);
+	}
+
+	void subBorrow(Operands &x)
+	{
+		sink = BigUnsignedKernels::subN(&x.r[0], &x.a[0], &x.b[0], x.n);
+	}
+
+	void shiftLeft(Operands &x)
+	{
+		sink = BigUnsignedKernels::shiftLeftBits(&x.r[0], &x.a[0], x.n, 13);
+	}
+
+	void shiftRight(Operands &x)
+	{
+		BigUnsignedKernels::shiftRightBits(&x.r[0], &x.a[0], x.n, 13);
+		sink = x.r[0];
+	}
+
+	//nanoseconds per call, repeating for at least ~20 ms
+	double timeKernel(Kernel f, Operands &x)
+	{
+		long reps = 0;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		double elapsed = 0;
+		do
+		{
+			for (int i = 0; i < 64; i++)
+			{
+				f(x);
+			}
+			reps += 64;
+			elapsed = std::chrono::duration<double>(
+				std::chrono::steady_clock::now() - start).count();
+		} while (elapsed < 0.02);
+		return elapsed / reps * 1e9;
+	}
+
+	//the startup choice, read in main; the AVX2 shifts must not be forced on
+	//without it
+	bool haveVector = false;
+
+	double timeShift(Kernel f, Operands &x, bool vector)
+	{
+		BigUnsignedKernels::vectorShifts = vector && haveVector;
+		double ns = timeKernel(f, x);
+		BigUnsignedKernels::vectorShifts = haveVector;
+		return ns;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int maxBlocks = (argc > 1) ? atoi(argv[1]) : 4096;
+	haveVector = BigUnsignedKernels::vectorShifts;
+
+	printf("AVX2 shifts %s\n", haveVector ? "available" : "unavailable");
+	printf("%8s %10s %10s %10s %10s %10s %10s %10s %10s\n", "blocks",
+		"add ns", "adc ns", "sub ns", "sbb ns", "shl ns", "shl vec",
+		"shr ns", "shr vec");
+	for (unsigned int n = 1; n <= maxBlocks; n *= 2)
+	{
+		Operands x;
+		x.n = n;
+		for (unsigned int i = 0; i < n; i++)
+		{
+			x.a.push_back(randomBlock());
+			x.b.push_back(randomBlock());
+		}
+		x.r.resize(n);
+
+		double add = timeKernel(addGeneric, x);
+		double adc = timeKernel(addCarry, x);
+		double sub = timeKernel(subGeneric, x);
+		double sbb = timeKernel(subBorrow, x);
+		double shl = timeShift(shiftLeft, x, false);
+		double shlVector = timeShift(shiftLeft, x, true);
+		double shr = timeShift(shiftRight, x, false);
+		double shrVector = timeShift(shiftRight, x, true);
+		printf("%8u %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+			n, add, adc, sub, sbb, shl, shlVector, shr, shrVector);
+	}
+	return 0;
+}
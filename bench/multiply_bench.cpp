@@ -0,0 +1,204 @@
+/**
+ * multiply_bench.cpp
+ *
+ * Times BigUnsigned::multiply on n x n block operands with the schoolbook
+ * method alone and with one Karatsuba split on top of schoolbook halves.
+ * The first size where the split wins is where karatsubaThreshold belongs;
+ * the last column is the full recursion with the threshold in use.
+ *
+ * A second table does the same for squaring, against a multiplication by an
+ * equal copy, to place karatsubaSquareThreshold.
+ *
+ * A third table times multiplication and squaring of larger operands
+ * without and with the number-theoretic transforms; the first size where
+ * the transforms win is where nttThreshold belongs.
+ *
+ * usage: multiply_bench [maxBlocks] [maxTransformBlocks]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "BigUnsigned.hh"
+#include "BigUnsignedKernels.hh"
+
+namespace {
+	const BigUnsignedKernels::Index NEVER = ~0U;
+
+	unsigned long long state = 88172645463325252ULL;
+
+	unsigned long randomBlock()
+	{
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		return (unsigned long)state;
+	}
+
+	BigUnsigned randomNumber(unsigned int blocks)
+	{
+		unsigned long *b = new unsigned long[blocks];
+		for (unsigned int i = 0; i < blocks; i++)
+		{
+			b[i] = randomBlock();
+		}
+		b[blocks - 1] |= 1;
+		BigUnsigned x(b, blocks);
+		delete [] b;
+		return x;
+	}
+
+	//microseconds per product (a * b, or a * a when square is set) with the
+	//given nttThreshold, repeating for at least ~100 ms
+	double timeTransform(const BigUnsigned &a, const BigUnsigned &b,
+		BigUnsignedKernels::Index threshold, bool square
+	) {
+		BigUnsignedKernels::nttThreshold = threshold;
+		BigUnsigned c;
+		long reps = 0;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		double elapsed = 0;
+		do
+		{
+			if (square)
+			{
+				c.multiply(a, a);
+			}
+			else
+			{
+				c.multiply(a, b);
+			}
+			reps++;
+			elapsed = std::chrono::duration<double>(
+				std::chrono::steady_clock::now() - start).count();
+		} while (elapsed < 0.1);
+		return elapsed / reps * 1e6;
+	}
+
+	//nanoseconds per multiply, repeating for at least ~20 ms
+	double timeMultiply(const BigUnsigned &a, const BigUnsigned &b,
+		BigUnsignedKernels::Index threshold
+	) {
+		BigUnsignedKernels::karatsubaThreshold = threshold;
+		BigUnsigned c;
+		long reps = 0;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		double elapsed = 0;
+		do
+		{
+			for (int i = 0; i < 8; i++)
+			{
+				c.multiply(a, b);
+			}
+			reps += 8;
+			elapsed = std::chrono::duration<double>(
+				std::chrono::steady_clock::now() - start).count();
+		} while (elapsed < 0.02);
+		return elapsed / reps * 1e9;
+	}
+
+	//nanoseconds per square of a with the given karatsubaSquareThreshold,
+	//repeating for at least ~20 ms
+	double timeSquare(const BigUnsigned &a, BigUnsignedKernels::Index threshold)
+	{
+		BigUnsignedKernels::karatsubaSquareThreshold = threshold;
+		BigUnsigned c;
+		long reps = 0;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		double elapsed = 0;
+		do
+		{
+			for (int i = 0; i < 8; i++)
+			{
+				c.square(a);
+			}
+			reps += 8;
+			elapsed = std::chrono::duration<double>(
+				std::chrono::steady_clock::now() - start).count();
+		} while (elapsed < 0.02);
+		return elapsed / reps * 1e9;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int maxBlocks = (argc > 1) ? atoi(argv[1]) : 1024;
+	BigUnsignedKernels::Index original = BigUnsignedKernels::karatsubaThreshold;
+
+	printf("%8s %14s %14s %8s %14s\n", "blocks", "schoolbook ns",
+		"one split ns", "ratio", "current ns");
+	unsigned int crossover = 0;
+	for (unsigned int n = 4; n <= maxBlocks; n += (n < 64) ? 4 : n / 4)
+	{
+		BigUnsigned a = randomNumber(n), b = randomNumber(n);
+		double schoolbook = timeMultiply(a, b, NEVER);
+		//threshold n: split once, the halves fall back to schoolbook
+		double karatsuba = timeMultiply(a, b, n);
+		double current = timeMultiply(a, b, original);
+		printf("%8u %14.0f %14.0f %8.2f %14.0f\n", n, schoolbook, karatsuba,
+			schoolbook / karatsuba, current);
+		if (crossover == 0 && karatsuba < schoolbook)
+		{
+			crossover = n;
+		}
+	}
+	printf("karatsuba first wins at %u blocks (threshold in use: %u)\n",
+		crossover, original);
+	BigUnsignedKernels::karatsubaThreshold = original;
+
+	BigUnsignedKernels::Index originalSquare =
+		BigUnsignedKernels::karatsubaSquareThreshold;
+	printf("\n%8s %14s %14s %14s %8s %14s\n", "blocks", "multiply ns",
+		"schoolbook ns", "one split ns", "ratio", "current ns");
+	crossover = 0;
+	for (unsigned int n = 4; n <= maxBlocks; n += (n < 64) ? 4 : n / 4)
+	{
+		BigUnsigned a = randomNumber(n), copy = a;
+		double multiply = timeMultiply(a, copy, original);
+		double schoolbook = timeSquare(a, NEVER);
+		double karatsuba = timeSquare(a, n);
+		double current = timeSquare(a, originalSquare);
+		printf("%8u %14.0f %14.0f %14.0f %8.2f %14.0f\n", n, multiply,
+			schoolbook, karatsuba, schoolbook / karatsuba, current);
+		if (crossover == 0 && karatsuba < schoolbook)
+		{
+			crossover = n;
+		}
+	}
+	printf("karatsuba squaring first wins at %u blocks (threshold in use: %u)\n",
+		crossover, originalSquare);
+	BigUnsignedKernels::karatsubaSquareThreshold = originalSquare;
+
+#ifdef BIGUNSIGNED_HAVE_NTT
+	unsigned int maxTransform = (argc > 2) ? atoi(argv[2]) : 32768;
+	BigUnsignedKernels::Index originalNtt = BigUnsignedKernels::nttThreshold;
+
+	printf("\n%8s %14s %14s %14s %14s\n", "blocks", "multiply us",
+		"transform us", "square us", "transform us");
+	unsigned int multiplyCrossover = 0, squareCrossover = 0;
+	for (unsigned int n = 512; n <= maxTransform; n += n / 2)
+	{
+		BigUnsigned a = randomNumber(n), b = randomNumber(n);
+		double multiply = timeTransform(a, b, NEVER, false);
+		double transform = timeTransform(a, b, 0, false);
+		double square = timeTransform(a, b, NEVER, true);
+		double squareTransform = timeTransform(a, b, 0, true);
+		printf("%8u %14.0f %14.0f %14.0f %14.0f\n", n, multiply, transform,
+			square, squareTransform);
+		if (multiplyCrossover == 0 && transform < multiply)
+		{
+			multiplyCrossover = n;
+		}
+		if (squareCrossover == 0 && squareTransform < square)
+		{
+			squareCrossover = n;
+		}
+	}
+	printf("transforms first win at %u blocks, %u squaring "
+		"(threshold in use: %u)\n", multiplyCrossover, squareCrossover,
+		originalNtt);
+	BigUnsignedKernels::nttThreshold = originalNtt;
+#endif
+	return 0;
+}
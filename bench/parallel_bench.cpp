@@ -0,0 +1,99 @@
+/**
+ * parallel_bench.cpp
+ *
+ * Times BigUnsigned::multiply on n x n block operands with multiplyThreads
+ * set to 1, 2, ... up to the given thread count, and prints the speedup over
+ * one thread.  Sizes below nttThreshold exercise the Karatsuba tasks, larger
+ * ones the split transforms.  The smallest size that gains from a second
+ * thread is where parallelThreshold belongs; it is set to 0 here so that
+ * every size is split.
+ *
+ * usage: parallel_bench [maxThreads] [maxBlocks]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "BigUnsigned.hh"
+#include "BigUnsignedKernels.hh"
+
+namespace {
+	unsigned long long state = 88172645463325252ULL;
+
+	unsigned long randomBlock()
+	{
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		return (unsigned long)state;
+	}
+
+	BigUnsigned randomNumber(unsigned int blocks)
+	{
+		unsigned long *b = new unsigned long[blocks];
+		for (unsigned int i = 0; i < blocks; i++)
+		{
+			b[i] = randomBlock();
+		}
+		b[blocks - 1] |= 1;
+		BigUnsigned x(b, blocks);
+		delete [] b;
+		return x;
+	}
+
+	//microseconds per multiply on the given number of threads, repeating for
+	//at least ~100 ms
+	double timeMultiply(const BigUnsigned &a, const BigUnsigned &b,
+		unsigned int threads, BigUnsigned &c
+	) {
+		BigUnsignedKernels::multiplyThreads = threads;
+		long reps = 0;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		double elapsed = 0;
+		do
+		{
+			c.multiply(a, b);
+			reps++;
+			elapsed = std::chrono::duration<double>(
+				std::chrono::steady_clock::now() - start).count();
+		} while (elapsed < 0.1);
+		return elapsed / reps * 1e6;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int hardware = std::thread::hardware_concurrency();
+	unsigned int maxThreads = (argc > 1) ? atoi(argv[1])
+		: (hardware == 0 ? 1 : hardware);
+	unsigned int maxBlocks = (argc > 2) ? atoi(argv[2]) : 65536;
+	unsigned int originalThreads = BigUnsignedKernels::multiplyThreads;
+	BigUnsignedKernels::Index originalThreshold = BigUnsignedKernels::parallelThreshold;
+	BigUnsignedKernels::parallelThreshold = 0;
+
+	printf("%8s %8s %14s %8s\n", "blocks", "threads", "multiply us", "speedup");
+	for (unsigned int n = 256; n <= maxBlocks; n *= 2)
+	{
+		BigUnsigned a = randomNumber(n), b = randomNumber(n);
+		BigUnsigned expected, c;
+		double one = timeMultiply(a, b, 1, expected);
+		printf("%8u %8u %14.0f %8.2f\n", n, 1, one, 1.0);
+		for (unsigned int threads = 2; threads <= maxThreads; threads++)
+		{
+			double time = timeMultiply(a, b, threads, c);
+			printf("%8u %8u %14.0f %8.2f\n", n, threads, time, one / time);
+			if (!(c == expected))
+			{
+				printf("results disagree\n");
+				return 1;
+			}
+		}
+	}
+	printf("threads in use: %u, parallelThreshold in use: %u\n",
+		originalThreads, originalThreshold);
+	BigUnsignedKernels::multiplyThreads = originalThreads;
+	BigUnsignedKernels::parallelThreshold = originalThreshold;
+	return 0;
+}
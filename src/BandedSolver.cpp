@@ -0,0 +1,54 @@
+/**
+ * BandedSolver.cpp
+ */
+
+#include <algorithm>
+
+#include "BandedSolver.h"
+
+using namespace std;
+
+int BandedSolver::rowWidth(int bandwidth)
+{
+	return 2 * bandwidth + 1;
+}
+
+int BandedSolver::index(int row, int col, int bandwidth)
+{
+	return row * rowWidth(bandwidth) + col - row + bandwidth;
+}
+
+void BandedSolver::solve(double *band, double *rhs, int n, int bandwidth)
+{
+	//forward elimination, also applied to rhs
+	for (int k = 0; k < n; k++)
+	{
+		double pivot = band[index(k, k, bandwidth)];
+		int last = min(n - 1, k + bandwidth);
+		for (int i = k + 1; i <= last; i++)
+		{
+			double factor = band[index(i, k, bandwidth)] / pivot;
+			if (factor == 0.0)
+			{
+				continue;
+			}
+			for (int j = k + 1; j <= last; j++)
+			{
+				band[index(i, j, bandwidth)] -= factor * band[index(k, j, bandwidth)];
+			}
+			rhs[i] -= factor * rhs[k];
+		}
+	}
+
+	//back substitution
+	for (int k = n - 1; k >= 0; k--)
+	{
+		double sum = rhs[k];
+		int last = min(n - 1, k + bandwidth);
+		for (int j = k + 1; j <= last; j++)
+		{
+			sum -= band[index(k, j, bandwidth)] * rhs[j];
+		}
+		rhs[k] = sum / band[index(k, k, bandwidth)];
+	}
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+/**
+ * In-place LU solve of a banded system without pivoting.
+ *
+ * The matrix is stored row by row with 2 * bandwidth + 1 entries per row:
+ * entry (row, col) lives at band[row * (2 * bandwidth + 1) + col - row +
+ * bandwidth].  Factoring overwrites the band and the solution overwrites
+ * the right hand side, so the caller's buffers are the only storage used.
+ * The Jacobians of the coupled diffusion systems are diagonally dominant,
+ * which is what makes skipping the pivoting safe.
+ */
+
+class BandedSolver
+{
+public:
+	static int rowWidth(int bandwidth);
+	static int index(int row, int col, int bandwidth);
+
+	//factors band and replaces rhs with the solution
+	static void solve(double *band, double *rhs, int n, int bandwidth);
+};
@@ -30,10 +30,18 @@ BigInteger::BigInteger(const Blk *b, Index blen, Sign s) : mag(b, blen) {
 }
 
 BigInteger::BigInteger(const BigUnsigned &x, Sign s) : mag(x) {
+	initSign(s);
+}
+
+BigInteger::BigInteger(BigUnsigned &&x, Sign s) : mag(std::move(x)) {
+	initSign(s);
+}
+
+void BigInteger::initSign(Sign s) {
 	switch (s) {
 	case zero:
 		if (!mag.isZero())
-			throw "BigInteger::BigInteger(const BigUnsigned &, Sign): Cannot use a sign of zero with a nonzero magnitude";
+			throw "BigInteger::BigInteger(BigUnsigned, Sign): Cannot use a sign of zero with a nonzero magnitude";
 		sign = zero;
 		break;
 	case positive:
@@ -44,7 +52,7 @@ BigInteger::BigInteger(const BigUnsigned &x, Sign s) : mag(x) {
 	default:
 		/* g++ seems to be optimizing out this case on the assumption
 		 * that the sign is a valid member of the enumeration.  Oh well. */
-		throw "BigInteger::BigInteger(const BigUnsigned &, Sign): Invalid sign";
+		throw "BigInteger::BigInteger(BigUnsigned, Sign): Invalid sign";
 	}
 }
 
@@ -162,7 +170,7 @@ BigInteger::CmpRes BigInteger::compareTo(const BigInteger &x) const {
 	if (cond) { \
 		BigInteger tmpThis; \
 		tmpThis.op; \
-		*this = tmpThis; \
+		swap(tmpThis); \
 		return; \
 	}
 
@@ -240,6 +248,74 @@ void BigInteger::subtract(const BigInteger &a, const BigInteger &b) {
 	}
 }
 
+/* Adds xSign * x.mag to *this in place, so that += and -= reuse the block
+ * array of mag.  Only a sign change that needs |x| - |*this| goes through a
+ * temporary. */
+void BigInteger::addInPlace(const BigInteger &x, Sign xSign) {
+	if (xSign == zero)
+		return;
+	if (sign == zero) {
+		mag = x.mag;
+		sign = xSign;
+	} else if (sign == xSign)
+		mag += x.mag;
+	else {
+		switch (mag.compareTo(x.mag)) {
+		case equal:
+			mag = 0;
+			sign = zero;
+			break;
+		case greater:
+			mag -= x.mag;
+			break;
+		case less:
+			mag.subtract(x.mag, mag);
+			sign = xSign;
+			break;
+		}
+	}
+}
+
+/* Adds productSign * |a| * |b| to *this in place.  Unlike addInPlace, the
+ * case where the result changes sign needs no temporary either: mag ends up
+ * holding its magnitude. */
+void BigInteger::addMulInPlace(const BigInteger &a, const BigInteger &b,
+		Sign productSign) {
+	if (productSign == zero)
+		return;
+	if (sign == zero)
+		sign = productSign;
+	if (mag.mulAccumulate(a.mag, b.mag, sign != productSign))
+		sign = productSign;
+	if (mag.isZero())
+		sign = zero;
+}
+
+void BigInteger::addMul(const BigInteger &a, const BigInteger &b) {
+	addMulInPlace(a, b, Sign(a.sign * b.sign));
+}
+
+void BigInteger::subMul(const BigInteger &a, const BigInteger &b) {
+	addMulInPlace(a, b, Sign(-a.sign * b.sign));
+}
+
+void BigInteger::operator +=(const BigInteger &x) {
+	if (this == &x) {
+		mag <<= 1;
+		return;
+	}
+	addInPlace(x, x.sign);
+}
+
+void BigInteger::operator -=(const BigInteger &x) {
+	if (this == &x) {
+		mag = 0;
+		sign = zero;
+		return;
+	}
+	addInPlace(x, Sign(-x.sign));
+}
+
 void BigInteger::multiply(const BigInteger &a, const BigInteger &b) {
 	DTRT_ALIASED(this == &a || this == &b, multiply(a, b));
 	// If one object is zero, copy zero and return.
@@ -255,6 +331,11 @@ void BigInteger::multiply(const BigInteger &a, const BigInteger &b) {
 	mag.multiply(a.mag, b.mag);
 }
 
+void BigInteger::square(const BigInteger &a) {
+	sign = (a.sign == zero) ? zero : positive;
+	mag.square(a.mag);
+}
+
 /*
  * DIVISION WITH REMAINDER
  * Please read the comments before the definition of
@@ -37,6 +37,26 @@ public:
 	// Assignment operator
 	void operator=(const BigInteger &x);
 
+	/* Move constructor and assignment: see BigUnsigned.  The moved-from
+	 * number is left zero, or holding the receiver's old value. */
+	BigInteger(BigInteger &&x) noexcept
+		: sign(x.sign), mag(std::move(x.mag)) {
+		x.sign = zero;
+	}
+	void operator=(BigInteger &&x) noexcept {
+		swap(x);
+	}
+
+	// Evaluates a fused sum of products; see BigIntegerExpression.hh.
+	template <unsigned int Terms>
+	void operator=(const BigIntegerSum<Terms> &x);
+
+	// Exchanges the values of *this and x.
+	void swap(BigInteger &x) noexcept {
+		std::swap(sign, x.sign);
+		mag.swap(x.mag);
+	}
+
 	// Constructor that copies from a given array of blocks with a sign.
 	BigInteger(const Blk *b, Index blen, Sign s);
 
@@ -47,11 +67,21 @@ public:
 
 	// Constructor from a BigUnsigned and a sign
 	BigInteger(const BigUnsigned &x, Sign s);
+	// Same, taking over the block array of a BigUnsigned that is expiring
+	BigInteger(BigUnsigned &&x, Sign s);
 
-	// Nonnegative constructor from a BigUnsigned
+	// Nonnegative constructors from a BigUnsigned, copied or taken over
 	BigInteger(const BigUnsigned &x) : mag(x) {
 		sign = mag.isZero() ? zero : positive;
 	}
+	BigInteger(BigUnsigned &&x) : mag(std::move(x)) {
+		sign = mag.isZero() ? zero : positive;
+	}
+
+protected:
+	// Sets the sign for a constructor given a magnitude and a sign.
+	void initSign(Sign s);
+public:
 
 	// Constructors from primitive integer types
 	BigInteger(unsigned long  x);
@@ -107,11 +137,23 @@ public:
 	void add     (const BigInteger &a, const BigInteger &b);
 	void subtract(const BigInteger &a, const BigInteger &b);
 	void multiply(const BigInteger &a, const BigInteger &b);
+	void square(const BigInteger &a);
 	/* See the comment on BigUnsigned::divideWithRemainder.  Semantics
 	 * differ from those of primitive integers when negatives and/or zeros
 	 * are involved. */
 	void divideWithRemainder(const BigInteger &b, BigInteger &q);
 	void negate(const BigInteger &a);
+	/* *this += a * b and *this -= a * b in mag's block array; see
+	 * BigUnsigned::addMul. */
+	void addMul(const BigInteger &a, const BigInteger &b);
+	void subMul(const BigInteger &a, const BigInteger &b);
+protected:
+	// Helper for += and -=
+	void addInPlace(const BigInteger &x, Sign xSign);
+	// Helper for addMul and subMul: adds productSign * |a| * |b|.
+	void addMulInPlace(const BigInteger &a, const BigInteger &b,
+			Sign productSign);
+public:
 	
 	/* Bitwise operators are not provided for BigIntegers.  Use
 	 * getMagnitude to get the magnitude and operate on that instead. */
@@ -183,12 +225,6 @@ inline BigInteger BigInteger::operator -() const {
  * belongs to the put-here operations.  See Assignment Operators in
  * BigUnsigned.hh.
  */
-inline void BigInteger::operator +=(const BigInteger &x) {
-	add(*this, x);
-}
-inline void BigInteger::operator -=(const BigInteger &x) {
-	subtract(*this, x);
-}
 inline void BigInteger::operator *=(const BigInteger &x) {
 	multiply(*this, x);
 }
@@ -199,7 +235,7 @@ inline void BigInteger::operator /=(const BigInteger &x) {
 	BigInteger q;
 	divideWithRemainder(x, q);
 	// *this contains the remainder, but we overwrite it with the quotient.
-	*this = q;
+	swap(q);
 }
 inline void BigInteger::operator %=(const BigInteger &x) {
 	if (x.isZero()) throw "BigInteger::operator %=: division by zero";
@@ -212,4 +248,8 @@ inline void BigInteger::flipSign() {
 	sign = Sign(-sign);
 }
 
+inline void swap(BigInteger &a, BigInteger &b) noexcept {
+	a.swap(b);
+}
+
 #endif
@@ -1,70 +1,261 @@
 #include "BigIntegerAlgorithms.hh"
+#include "BigUnsignedDivisor.hh"
+#include "BigUnsignedKernels.hh"
+#include "BigIntegerExpression.hh"
 
-BigUnsigned gcd(BigUnsigned a, BigUnsigned b) {
-	BigUnsigned trash;
-	// Neat in-place alternating technique.
-	for (;;) {
+/* Each algorithm runs in a ScopedBlockArena, so the temporaries of its loop
+ * recycle a few pooled arrays instead of going to the heap every time.  The
+ * arena is closed before the results are copied out, which puts them back on
+ * the heap and lets the arena be released on return. */
+
+namespace {
+	typedef BigUnsigned::Blk Blk;
+	typedef BigUnsigned::Index Index;
+
+	// Number of trailing zero bits of a nonzero x.
+	Index trailingZeros(const BigUnsigned &x) {
+		Index i = 0;
+		while (x.getBlock(i) == 0)
+			i++;
+		return i * BigUnsigned::N
+			+ BigUnsignedKernels::countTrailingZeros(x.getBlock(i));
+	}
+
+	// Binary GCD of two blocks.
+	Blk gcdBlock(Blk u, Blk v) {
+		if (u == 0)
+			return v;
+		if (v == 0)
+			return u;
+		unsigned int shift = BigUnsignedKernels::countTrailingZeros(u | v);
+		u >>= BigUnsignedKernels::countTrailingZeros(u);
+		do {
+			v >>= BigUnsignedKernels::countTrailingZeros(v);
+			if (u > v) {
+				Blk t = u; u = v; v = t;
+			}
+			v -= u;
+		} while (v != 0);
+		return u << shift;
+	}
+
+	/* Lehmer's method (Knuth, vol. 2, 4.5.2, Algorithm L) runs Euclid's
+	 * algorithm on the leading 62 bits of a and b, tracking the matrix
+	 * (A B; C D) that maps (a, b) to the current pair, for as long as the
+	 * quotients provably agree with those of the full numbers.  Applying
+	 * the matrix then does many division steps with four multiplications
+	 * by a block.  The entries stay below 2^62 in magnitude, so the sums in
+	 * the test cannot overflow. */
+	const unsigned int leadingBits = BigUnsigned::N - 2;
+
+	struct LehmerMatrix {
+		long a, b, c, d;
+	};
+
+	// Bits [s, s + leadingBits) of x.
+	long bitsAt(const BigUnsigned &x, Index s) {
+		Index i = s / BigUnsigned::N;
+		unsigned int r = s % BigUnsigned::N;
+		Blk bits = x.getBlock(i) >> r;
+		if (r != 0)
+			bits |= x.getBlock(i + 1) << (BigUnsigned::N - r);
+		return long(bits & ((Blk(1) << leadingBits) - 1));
+	}
+
+	/* For a >= b > 0, finds the matrix and returns true, or returns false if
+	 * not even one quotient is certain, in which case the caller should do
+	 * an ordinary division step. */
+	bool lehmerMatrix(const BigUnsigned &a, const BigUnsigned &b,
+			LehmerMatrix &m) {
+		Index bits = a.bitLength();
+		Index s = (bits > leadingBits) ? bits - leadingBits : 0;
+		long x = bitsAt(a, s), y = bitsAt(b, s);
+		long A = 1, B = 0, C = 0, D = 1;
+		while (y + C > 0 && y + D > 0) {
+			long q = (x + A) / (y + C);
+			if (q != (x + B) / (y + D))
+				break;
+			long t = A - q * C; A = C; C = t;
+			t = B - q * D; B = D; D = t;
+			t = x - q * y; x = y; y = t;
+		}
+		m.a = A; m.b = B; m.c = C; m.d = D;
+		return B != 0;
+	}
+
+	/* r = s x + t y, which the caller knows is nonnegative, for s and t of
+	 * opposite signs (or zero).  tmp is scratch. */
+	void combine(BigUnsigned &r, long s, const BigUnsigned &x,
+			long t, const BigUnsigned &y, BigUnsigned &tmp) {
+		if (t <= 0) {
+			r.multiply(x, BigUnsigned((unsigned long)s));
+			tmp.multiply(y, BigUnsigned((unsigned long)-t));
+		} else {
+			r.multiply(y, BigUnsigned((unsigned long)t));
+			tmp.multiply(x, BigUnsigned((unsigned long)-s));
+		}
+		r -= tmp;
+	}
+}
+
+BigUnsigned gcd(const BigUnsigned &x, const BigUnsigned &y) {
+	ScopedBlockArena arena;
+	BigUnsigned a(x), b(y), a2, b2, tmp;
+	if (a < b)
+		a.swap(b);
+	// Invariant: a >= b.
+	while (b.getLength() > 1) {
+		LehmerMatrix m;
+		if (lehmerMatrix(a, b, m)) {
+			combine(a2, m.a, a, m.b, b, tmp);
+			combine(b2, m.c, a, m.d, b, tmp);
+			a.swap(a2);
+			b.swap(b2);
+		} else {
+			a.divideWithRemainder(b, tmp);
+			a.swap(b);
+		}
+	}
+	// Finish on single blocks.
+	if (!b.isZero()) {
+		a.divideWithRemainder(b, tmp);
+		a = gcdBlock(a.getBlock(0), b.getBlock(0));
+	}
+	arena.close();
+	return BigUnsigned(a);
+}
+
+BigUnsigned binaryGcd(const BigUnsigned &x, const BigUnsigned &y) {
+	if (x.isZero())
+		return y;
+	if (y.isZero())
+		return x;
+	ScopedBlockArena arena;
+	BigUnsigned a(x), b(y);
+	Index za = trailingZeros(a), zb = trailingZeros(b);
+	a >>= za;
+	b >>= zb;
+	// Both odd: subtract the smaller from the larger and strip the twos.
+	while (a.getLength() > 1 || b.getLength() > 1) {
+		switch (a.compareTo(b)) {
+		case BigUnsigned::equal:
+			b = 0;
+			break;
+		case BigUnsigned::less:
+			a.swap(b);
+			// Fall through.
+		case BigUnsigned::greater:
+			a -= b;
+			a >>= trailingZeros(a);
+			break;
+		}
 		if (b.isZero())
-			return a;
-		a.divideWithRemainder(b, trash);
-		if (a.isZero())
-			return b;
-		b.divideWithRemainder(a, trash);
+			break;
 	}
+	if (!b.isZero())
+		a = gcdBlock(a.getBlock(0), b.getBlock(0));
+	a <<= (za < zb) ? za : zb;
+	arena.close();
+	return BigUnsigned(a);
 }
 
 void extendedEuclidean(BigInteger m, BigInteger n,
 		BigInteger &g, BigInteger &r, BigInteger &s) {
 	if (&g == &r || &g == &s || &r == &s)
 		throw "BigInteger extendedEuclidean: Outputs are aliased";
+	ScopedBlockArena arena;
 	BigInteger r1(1), s1(0), r2(0), s2(1), q;
 	/* Invariants:
 	 * r1*m(orig) + s1*n(orig) == m(current)
 	 * r2*m(orig) + s2*n(orig) == n(current) */
 	for (;;) {
 		if (n.isZero()) {
+			arena.close();
 			r = r1; s = s1; g = m;
 			return;
 		}
 		// Subtract q times the second invariant from the first invariant.
 		m.divideWithRemainder(n, q);
-		r1 -= q*r2; s1 -= q*s2;
+		r1.subMul(q, r2); s1.subMul(q, s2);
 
 		if (m.isZero()) {
+			arena.close();
 			r = r2; s = s2; g = n;
 			return;
 		}
 		// Subtract q times the first invariant from the second invariant.
 		n.divideWithRemainder(m, q);
-		r2 -= q*r1; s2 -= q*s1;
+		r2.subMul(q, r1); s2.subMul(q, s1);
 	}
 }
 
+/* Lehmer's method again, on n and x mod n, carrying the multiplier of x
+ * that gives each remainder mod n; the matrix and the quotients apply to the
+ * multipliers just as to the remainders. */
 BigUnsigned modinv(const BigInteger &x, const BigUnsigned &n) {
-	BigInteger g, r, s;
-	extendedEuclidean(x, n, g, r, s);
-	if (g == 1)
-		// r*x + s*n == 1, so r*x === 1 (mod n), so r is the answer.
-		return (r % n).getMagnitude(); // (r % n) will be nonnegative
-	else
+	BigUnsigned b = (x % BigInteger(n)).getMagnitude();
+	ScopedBlockArena arena;
+	BigUnsigned a(n), a2, b2, tmp;
+	// Invariant: a == ua * x and b == ub * x (mod n), and a > b.
+	BigInteger ua(0), ub(1), ua2, ub2;
+	while (!b.isZero()) {
+		LehmerMatrix m;
+		if (lehmerMatrix(a, b, m)) {
+			combine(a2, m.a, a, m.b, b, tmp);
+			combine(b2, m.c, a, m.d, b, tmp);
+			a.swap(a2);
+			b.swap(b2);
+			// Block-by-number products, accumulated in place
+			ua2 = fused(ua) * m.a + fused(ub) * m.b;
+			ub2 = fused(ua) * m.c + fused(ub) * m.d;
+			ua.swap(ua2);
+			ub.swap(ub2);
+		} else {
+			a.divideWithRemainder(b, tmp);
+			a.swap(b);
+			ua2 = ua - fused(tmp) * ub;
+			ua.swap(ub);
+			ub.swap(ua2);
+		}
+	}
+	if (!(a == 1))
 		throw "BigInteger modinv: x and n have a common factor";
+	// (ua % n) will be nonnegative
+	ua = ua % BigInteger(n);
+	arena.close();
+	return BigUnsigned(ua.getMagnitude());
 }
 
 BigUnsigned modexp(const BigInteger &base, const BigUnsigned &exponent,
 		const BigUnsigned &modulus) {
-	BigUnsigned ans = 1, base2 = (base % modulus).getMagnitude();
+	BigUnsigned base2 = (base % modulus).getMagnitude();
+	if (modulus.getBit(0))
+		return MontgomeryContext(modulus).modexp(base2, exponent);
+
+	/* Even moduli have no Montgomery form; square and multiply, reducing
+	 * by a divisor prepared once for all the reductions. */
+	ScopedBlockArena arena;
+	BigUnsignedDivisor divisor(modulus);
+	BigUnsigned ans = 1, q;
 	BigUnsigned::Index i = exponent.bitLength();
 	// For each bit of the exponent, most to least significant...
 	while (i > 0) {
 		i--;
 		// Square.
-		ans *= ans;
-		ans %= modulus;
+		ans.square(ans);
+		ans.divideWithRemainder(divisor, q);
 		// And multiply if the bit is a 1.
 		if (exponent.getBit(i)) {
 			ans *= base2;
-			ans %= modulus;
+			ans.divideWithRemainder(divisor, q);
 		}
 	}
-	return ans;
+	arena.close();
+	return BigUnsigned(ans);
+}
+
+BigUnsigned modexp(const BigInteger &base, const BigUnsigned &exponent,
+		const MontgomeryContext &context) {
+	return context.modexp((base % context.getModulus()).getMagnitude(),
+			exponent);
 }
@@ -2,12 +2,19 @@
 #define BIGINTEGERALGORITHMS_H
 
 #include "BigInteger.hh"
+#include "MontgomeryContext.hh"
 
 /* Some mathematical algorithms for big integers.
  * This code is new and, as such, experimental. */
 
-// Returns the greatest common divisor of a and b.
-BigUnsigned gcd(BigUnsigned a, BigUnsigned b);
+/* Returns the greatest common divisor of a and b, by Lehmer's method: most
+ * division steps are done on the leading bits in machine words. */
+BigUnsigned gcd(const BigUnsigned &a, const BigUnsigned &b);
+
+/* The same by the binary method: shifts and subtractions only.  About twice
+ * as fast as Euclid's division steps but slower than gcd beyond two blocks;
+ * see bench/gcd_bench.cpp. */
+BigUnsigned binaryGcd(const BigUnsigned &a, const BigUnsigned &b);
 
 /* Extended Euclidean algorithm.
  * Given m and n, finds gcd g and numbers r, s such that r*m + s*n == g. */
@@ -18,8 +25,14 @@ void extendedEuclidean(BigInteger m, BigInteger n,
  * they have a common factor. */
 BigUnsigned modinv(const BigInteger &x, const BigUnsigned &n);
 
-// Returns (base ^ exponent) % modulus.
+/* Returns (base ^ exponent) % modulus.  Odd moduli go through a
+ * MontgomeryContext made for the call. */
 BigUnsigned modexp(const BigInteger &base, const BigUnsigned &exponent,
 		const BigUnsigned &modulus);
 
+/* The same with a context made once and reused for every exponentiation
+ * with its modulus. */
+BigUnsigned modexp(const BigInteger &base, const BigUnsigned &exponent,
+		const MontgomeryContext &context);
+
 #endif
@@ -0,0 +1,91 @@
+#include "BigIntegerExpression.hh"
+#include "BigUnsignedKernels.hh"
+#include "BlockArena.hh"
+
+/* The accumulator is r's block array, n blocks long, holding a magnitude
+ * with a separate sign.  A term with the accumulator's sign is added in; one
+ * with the opposite sign is subtracted, and if that borrows out of the top
+ * block the accumulator holds the two's complement of the magnitude, which
+ * is negated back and the sign flipped.  The magnitude never exceeds the sum
+ * of the magnitudes of the terms so far, which is less than (number of
+ * terms) times B^m for the longest term of m blocks, so n = m + 1 blocks
+ * always hold it. */
+
+BigIntegerTerm::Sign BigIntegerTerm::evaluate(BigUnsigned &r,
+		const BigIntegerTerm *terms, Index count) {
+	using namespace BigUnsignedKernels;
+	// Size the accumulator and the scratch array for the products.
+	Index n = 0, scratchLen = 0;
+	for (Index i = 0; i < count; i++) {
+		const BigIntegerTerm &t = terms[i];
+		if (t.sign == BigInteger::zero)
+			continue;
+		Index len = t.a->len + (t.b != NULL ? t.b->len : 1);
+		if (len > n)
+			n = len;
+		if (t.b != NULL && len > scratchLen)
+			scratchLen = len;
+	}
+	if (n == 0) {
+		r.len = 0;
+		return BigInteger::zero;
+	}
+	n++;
+	r.allocate(n);
+
+	Blk *acc = r.blk, *scratch = NULL;
+	// Allocated at the first product
+	BlockMemory::ScopedArray<Blk> scratchArray;
+	Sign sign = BigInteger::zero;
+	for (Index i = 0; i < count; i++) {
+		const BigIntegerTerm &t = terms[i];
+		if (t.sign == BigInteger::zero)
+			continue;
+		const Blk *a = t.a->blk;
+		Index an = t.a->len, len;
+
+		// The first term is stored instead of added.
+		if (sign == BigInteger::zero) {
+			if (t.b == NULL) {
+				len = an + 1;
+				acc[an] = mulWord(acc, a, an, t.w);
+			} else {
+				len = an + t.b->len;
+				if (t.a == t.b)
+					square(acc, a, an);
+				else
+					multiply(acc, a, an, t.b->blk, t.b->len);
+			}
+			for (Index j = len; j < n; j++)
+				acc[j] = 0;
+			sign = t.sign;
+			continue;
+		}
+
+		Blk carry;
+		if (t.b == NULL) {
+			len = an;
+			carry = (t.sign == sign) ? addMulWord(acc, a, an, t.w)
+				: subMulWord(acc, a, an, t.w);
+		} else {
+			len = an + t.b->len;
+			if (scratch == NULL)
+				scratch = scratchArray.allocate(scratchLen);
+			if (t.a == t.b)
+				square(scratch, a, an);
+			else
+				multiply(scratch, a, an, t.b->blk, t.b->len);
+			carry = (t.sign == sign) ? addN(acc, acc, scratch, len)
+				: subN(acc, acc, scratch, len);
+		}
+		if (t.sign == sign)
+			addWord(acc + len, acc + len, n - len, carry);
+		else if (subWord(acc + len, acc + len, n - len, carry) != 0) {
+			negateN(acc, n);
+			sign = Sign(-sign);
+		}
+	}
+	r.len = n;
+	r.zapLeadingZeros();
+	return r.isZero() ? BigInteger::zero : sign;
+}
@@ -0,0 +1,271 @@
+#ifndef BIGINTEGEREXPRESSION_H
+#define BIGINTEGEREXPRESSION_H
+
+#include "BigInteger.hh"
+
+/* Fused evaluation of sums of products, such as a*b + c*d - e.
+ *
+ * With the ordinary operators each product and each partial sum is a
+ * BigInteger of its own, allocated and then thrown away.  Marking the first
+ * operand with `fused' makes the operators build a BigIntegerSum instead: a
+ * list of signed terms, each an operand or the product of two operands (or of
+ * an operand and a long), holding references to the operands and doing no
+ * arithmetic yet.  Assigning the sum to a BigInteger or BigUnsigned sizes the
+ * destination once for the largest term and accumulates the terms straight
+ * into its block array with the multiply-accumulate kernels; a product by a
+ * long never leaves that array, and the other products share one scratch
+ * array.  Example:
+ *     BigInteger r;
+ *     r = fused(a) * b + fused(c) * d - e;
+ *     r = fused(u) * 3 - fused(v) * q;
+ *
+ * Anything else falls back to the ordinary operators: multiplying or
+ * dividing a sum evaluates it to a BigInteger first, and a sum converts to a
+ * BigInteger wherever one is expected.  The destination may appear among the
+ * operands; that case goes through a temporary.
+ *
+ * A sum refers to its operands, so it must be assigned or converted within
+ * the statement that builds it, before any temporaries it uses are gone. */
+
+class BigIntegerTerm {
+
+public:
+	typedef BigUnsigned::Blk Blk;
+	typedef BigUnsigned::Index Index;
+	typedef BigInteger::Sign Sign;
+
+	/* The term is sign * a * b, or sign * a * w when b is NULL.  A zero
+	 * term may have any of these zero. */
+	Sign sign;
+	const BigUnsigned *a;
+	const BigUnsigned *b;
+	Blk w;
+
+	BigIntegerTerm() : sign(BigInteger::zero), a(NULL), b(NULL), w(0) {}
+
+	// The term x.
+	explicit BigIntegerTerm(const BigInteger &x)
+		: sign(x.getSign()), a(&x.getMagnitude()), b(NULL), w(1) {}
+	explicit BigIntegerTerm(const BigUnsigned &x)
+		: sign(x.isZero() ? BigInteger::zero : BigInteger::positive),
+		  a(&x), b(NULL), w(1) {}
+
+	// The term with the opposite sign.
+	BigIntegerTerm negated() const {
+		BigIntegerTerm t(*this);
+		t.sign = Sign(-sign);
+		return t;
+	}
+
+	/* Stores the sum of the count terms in r and returns its sign.  r must
+	 * not be the magnitude of any operand. */
+	static Sign evaluate(BigUnsigned &r, const BigIntegerTerm *terms,
+			Index count);
+
+	// Whether x is an operand of one of the count terms.
+	static bool refersTo(const BigUnsigned &x, const BigIntegerTerm *terms,
+			Index count) {
+		for (Index i = 0; i < count; i++)
+			if (terms[i].a == &x || terms[i].b == &x)
+				return true;
+		return false;
+	}
+};
+
+// A sum of Terms signed terms; see above.
+template <unsigned int Terms>
+class BigIntegerSum {
+
+public:
+	BigIntegerTerm terms[Terms];
+
+	BigIntegerSum() {}
+
+	// The sum with every sign flipped.
+	BigIntegerSum operator -() const {
+		BigIntegerSum s;
+		for (unsigned int i = 0; i < Terms; i++)
+			s.terms[i] = terms[i].negated();
+		return s;
+	}
+
+	// Evaluates the sum.
+	operator BigInteger() const {
+		BigInteger r;
+		r = *this;
+		return r;
+	}
+};
+
+/* An operand marked by `fused'.  It is itself the one-term sum x, and its
+ * products are product terms rather than BigIntegers. */
+class BigIntegerFactor : public BigIntegerSum<1> {
+
+public:
+	explicit BigIntegerFactor(const BigInteger &x) {
+		terms[0] = BigIntegerTerm(x);
+	}
+	explicit BigIntegerFactor(const BigUnsigned &x) {
+		terms[0] = BigIntegerTerm(x);
+	}
+
+	// The marked operand as a term
+	const BigIntegerTerm &term() const { return terms[0]; }
+};
+
+inline BigIntegerFactor fused(const BigInteger &x) {
+	return BigIntegerFactor(x);
+}
+inline BigIntegerFactor fused(const BigUnsigned &x) {
+	return BigIntegerFactor(x);
+}
+
+// PRODUCT TERMS
+
+inline BigIntegerSum<1> operator *(const BigIntegerFactor &x,
+		const BigIntegerFactor &y) {
+	BigIntegerSum<1> s;
+	s.terms[0] = x.term();
+	s.terms[0].sign = BigInteger::Sign(x.term().sign * y.term().sign);
+	s.terms[0].b = y.term().a;
+	return s;
+}
+inline BigIntegerSum<1> operator *(const BigIntegerFactor &x,
+		const BigInteger &y) {
+	return x * BigIntegerFactor(y);
+}
+inline BigIntegerSum<1> operator *(const BigInteger &x,
+		const BigIntegerFactor &y) {
+	return BigIntegerFactor(x) * y;
+}
+inline BigIntegerSum<1> operator *(const BigIntegerFactor &x,
+		const BigUnsigned &y) {
+	return x * BigIntegerFactor(y);
+}
+inline BigIntegerSum<1> operator *(const BigUnsigned &x,
+		const BigIntegerFactor &y) {
+	return BigIntegerFactor(x) * y;
+}
+// A product by a long, which is accumulated a block at a time.
+inline BigIntegerSum<1> operator *(const BigIntegerFactor &x, long y) {
+	BigIntegerSum<1> s;
+	s.terms[0] = x.term();
+	if (y < 0) {
+		s.terms[0] = s.terms[0].negated();
+		s.terms[0].w = 0 - BigUnsigned::Blk(y);
+	} else
+		s.terms[0].w = BigUnsigned::Blk(y);
+	if (y == 0)
+		s.terms[0].sign = BigInteger::zero;
+	return s;
+}
+inline BigIntegerSum<1> operator *(long x, const BigIntegerFactor &y) {
+	return y * x;
+}
+
+// SUMS
+
+template <unsigned int K, unsigned int M>
+BigIntegerSum<K + M> operator +(const BigIntegerSum<K> &x,
+		const BigIntegerSum<M> &y) {
+	BigIntegerSum<K + M> s;
+	for (unsigned int i = 0; i < K; i++)
+		s.terms[i] = x.terms[i];
+	for (unsigned int i = 0; i < M; i++)
+		s.terms[K + i] = y.terms[i];
+	return s;
+}
+template <unsigned int K, unsigned int M>
+BigIntegerSum<K + M> operator -(const BigIntegerSum<K> &x,
+		const BigIntegerSum<M> &y) {
+	return x + -y;
+}
+template <unsigned int K>
+BigIntegerSum<K + 1> operator +(const BigIntegerSum<K> &x,
+		const BigInteger &y) {
+	return x + BigIntegerFactor(y);
+}
+template <unsigned int K>
+BigIntegerSum<K + 1> operator -(const BigIntegerSum<K> &x,
+		const BigInteger &y) {
+	return x - BigIntegerFactor(y);
+}
+template <unsigned int K>
+BigIntegerSum<K + 1> operator +(const BigInteger &x,
+		const BigIntegerSum<K> &y) {
+	return BigIntegerFactor(x) + y;
+}
+template <unsigned int K>
+BigIntegerSum<K + 1> operator -(const BigInteger &x,
+		const BigIntegerSum<K> &y) {
+	return BigIntegerFactor(x) - y;
+}
+
+/* FALLBACKS
+ * Products and quotients of whole sums are ordinary BigInteger operations
+ * on the evaluated sums. */
+
+template <unsigned int K>
+BigInteger operator *(const BigIntegerSum<K> &x, const BigInteger &y) {
+	return BigInteger(x) * y;
+}
+template <unsigned int K>
+BigInteger operator *(const BigInteger &x, const BigIntegerSum<K> &y) {
+	return x * BigInteger(y);
+}
+template <unsigned int K, unsigned int M>
+BigInteger operator *(const BigIntegerSum<K> &x, const BigIntegerSum<M> &y) {
+	return BigInteger(x) * BigInteger(y);
+}
+template <unsigned int K>
+BigInteger operator /(const BigIntegerSum<K> &x, const BigInteger &y) {
+	return BigInteger(x) / y;
+}
+template <unsigned int K>
+BigInteger operator /(const BigInteger &x, const BigIntegerSum<K> &y) {
+	return x / BigInteger(y);
+}
+template <unsigned int K, unsigned int M>
+BigInteger operator /(const BigIntegerSum<K> &x, const BigIntegerSum<M> &y) {
+	return BigInteger(x) / BigInteger(y);
+}
+template <unsigned int K>
+BigInteger operator %(const BigIntegerSum<K> &x, const BigInteger &y) {
+	return BigInteger(x) % y;
+}
+template <unsigned int K>
+BigInteger operator %(const BigInteger &x, const BigIntegerSum<K> &y) {
+	return x % BigInteger(y);
+}
+template <unsigned int K, unsigned int M>
+BigInteger operator %(const BigIntegerSum<K> &x, const BigIntegerSum<M> &y) {
+	return BigInteger(x) % BigInteger(y);
+}
+
+// ASSIGNMENT (declared in BigUnsigned.hh and BigInteger.hh)
+
+template <unsigned int Terms>
+void BigInteger::operator =(const BigIntegerSum<Terms> &x) {
+	if (BigIntegerTerm::refersTo(mag, x.terms, Terms)) {
+		BigInteger tmp;
+		tmp = x;
+		swap(tmp);
+		return;
+	}
+	sign = BigIntegerTerm::evaluate(mag, x.terms, Terms);
+}
+
+template <unsigned int Terms>
+void BigUnsigned::operator =(const BigIntegerSum<Terms> &x) {
+	if (BigIntegerTerm::refersTo(*this, x.terms, Terms)) {
+		BigUnsigned tmp;
+		tmp = x;
+		swap(tmp);
+		return;
+	}
+	if (BigIntegerTerm::evaluate(*this, x.terms, Terms) == BigInteger::negative)
+		throw "BigUnsigned::operator =(const BigIntegerSum &): "
+			"Negative result in unsigned calculation";
+}
+
+#endif
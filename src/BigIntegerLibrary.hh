@@ -2,7 +2,10 @@
 
 #include "NumberlikeArray.hh"
 #include "BigUnsigned.hh"
+#include "BigUnsignedDivisor.hh"
 #include "BigInteger.hh"
 #include "BigIntegerAlgorithms.hh"
 #include "BigUnsignedInABase.hh"
 #include "BigIntegerUtils.hh"
+#include "FixedBigUnsigned.hh"
+#include "BigIntegerExpression.hh"
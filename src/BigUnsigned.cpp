@@ -1,4 +1,6 @@
 #include "BigUnsigned.hh"
+#include "BigUnsignedKernels.hh"
+#include "BlockArena.hh"
 
 // Memory management definitions have moved to the bottom of NumberlikeArray.hh.
 
@@ -115,7 +117,7 @@ BigUnsigned::CmpRes BigUnsigned::compareTo(const BigUnsigned &x) const {
 	if (cond) { \
 		BigUnsigned tmpThis; \
 		tmpThis.op; \
-		*this = tmpThis; \
+		swap(tmpThis); \
 		return; \
 	}
 
@@ -131,11 +133,6 @@ void BigUnsigned::add(const BigUnsigned &a, const BigUnsigned &b) {
 		operator =(a);
 		return;
 	}
-	// Some variables...
-	// Carries in and out of an addition stage
-	bool carryIn, carryOut;
-	Blk temp;
-	Index i;
 	// a2 points to the longer input, b2 points to the shorter
 	const BigUnsigned *a2, *b2;
 	if (a.len >= b.len) {
@@ -148,35 +145,14 @@ void BigUnsigned::add(const BigUnsigned &a, const BigUnsigned &b) {
 	// Set prelimiary length and make room in this BigUnsigned
 	len = a2->len + 1;
 	allocate(len);
-	// For each block index that is present in both inputs...
-	for (i = 0, carryIn = false; i < b2->len; i++) {
-		// Add input blocks
-		temp = a2->blk[i] + b2->blk[i];
-		// If a rollover occurred, the result is less than either input.
-		// This test is used many times in the BigUnsigned code.
-		carryOut = (temp < a2->blk[i]);
-		// If a carry was input, handle it
-		if (carryIn) {
-			temp++;
-			carryOut |= (temp == 0);
-		}
-		blk[i] = temp; // Save the addition result
-		carryIn = carryOut; // Pass the carry along
-	}
-	// If there is a carry left over, increase blocks until
-	// one does not roll over.
-	for (; i < a2->len && carryIn; i++) {
-		temp = a2->blk[i] + 1;
-		carryIn = (temp == 0);
-		blk[i] = temp;
-	}
-	// If the carry was resolved but the larger number
-	// still has blocks, copy them over.
-	for (; i < a2->len; i++)
-		blk[i] = a2->blk[i];
+	/* Add the blocks present in both inputs, then carry through the rest of
+	 * the longer one; see BigUnsignedKernels.hh. */
+	using namespace BigUnsignedKernels;
+	Blk carry = addN(blk, a2->blk, b2->blk, b2->len);
+	carry = addWord(blk + b2->len, a2->blk + b2->len, a2->len - b2->len, carry);
 	// Set the extra block if there's still a carry, decrease length otherwise
-	if (carryIn)
-		blk[i] = 1;
+	if (carry != 0)
+		blk[a2->len] = 1;
 	else
 		len--;
 }
@@ -191,43 +167,19 @@ void BigUnsigned::subtract(const BigUnsigned &a, const BigUnsigned &b) {
 		// If a is shorter than b, the result is negative.
 		throw "BigUnsigned::subtract: "
 			"Negative result in unsigned calculation";
-	// Some variables...
-	bool borrowIn, borrowOut;
-	Blk temp;
-	Index i;
 	// Set preliminary length and make room
 	len = a.len;
 	allocate(len);
-	// For each block index that is present in both inputs...
-	for (i = 0, borrowIn = false; i < b.len; i++) {
-		temp = a.blk[i] - b.blk[i];
-		// If a reverse rollover occurred,
-		// the result is greater than the block from a.
-		borrowOut = (temp > a.blk[i]);
-		// Handle an incoming borrow
-		if (borrowIn) {
-			borrowOut |= (temp == 0);
-			temp--;
-		}
-		blk[i] = temp; // Save the subtraction result
-		borrowIn = borrowOut; // Pass the borrow along
-	}
-	// If there is a borrow left over, decrease blocks until
-	// one does not reverse rollover.
-	for (; i < a.len && borrowIn; i++) {
-		borrowIn = (a.blk[i] == 0);
-		blk[i] = a.blk[i] - 1;
-	}
+	using namespace BigUnsignedKernels;
+	Blk borrow = subN(blk, a.blk, b.blk, b.len);
+	borrow = subWord(blk + b.len, a.blk + b.len, a.len - b.len, borrow);
 	/* If there's still a borrow, the result is negative.
 	 * Throw an exception, but zero out this object so as to leave it in a
 	 * predictable state. */
-	if (borrowIn) {
+	if (borrow != 0) {
 		len = 0;
 		throw "BigUnsigned::subtract: Negative result in unsigned calculation";
-	} else
-		// Copy over the rest of the blocks
-		for (; i < a.len; i++)
-			blk[i] = a.blk[i];
+	}
 	// Zap leading zeros
 	zapLeadingZeros();
 }
@@ -252,51 +204,16 @@ void BigUnsigned::subtract(const BigUnsigned &a, const BigUnsigned &b) {
  * A future version of the library might include such algorithms; I
  * would welcome contributions from others for this.
  *
- * I eventually decided to use bit-shifting algorithms.  To multiply `a'
- * and `b', we zero out the result.  Then, for each `1' bit in `a', we
- * shift `b' left the appropriate amount and add it to the result.
- * Similarly, to divide `a' by `b', we shift `b' left varying amounts,
- * repeatedly trying to subtract it from `a'.  When we succeed, we note
- * the fact by setting a bit in the quotient.  While these algorithms
- * have the same O(n^2) time complexity as Knuth's, the ``constant factor''
- * is likely to be larger.
+ * I eventually decided to use bit-shifting algorithms, which have the same
+ * O(n^2) time complexity as Knuth's with a much larger constant factor.
  *
- * Because I used these algorithms, which require single-block addition
- * and subtraction rather than single-block multiplication and division,
- * the innermost loops of all four routines are very similar.  Study one
- * of them and all will become clear.
+ * Both have since moved to word-level algorithms built on exactly those
+ * operations (through a double-width type, or half blocks where there is
+ * none), in BigUnsignedKernels.hh: schoolbook and Karatsuba multiplication
+ * in BigUnsignedMultiply.cpp and Knuth's Algorithm D in
+ * BigUnsignedDivide.cpp.
  */
 
-/*
- * This is a little inline function used by both the multiplication
- * routine and the division routine.
- *
- * `getShiftedBlock' returns the `x'th block of `num << y'.
- * `y' may be anything from 0 to N - 1, and `x' may be anything from
- * 0 to `num.len'.
- *
- * Two things contribute to this block:
- *
- * (1) The `N - y' low bits of `num.blk[x]', shifted `y' bits left.
- *
- * (2) The `y' high bits of `num.blk[x-1]', shifted `N - y' bits right.
- *
- * But we must be careful if `x == 0' or `x == num.len', in
- * which case we should use 0 instead of (2) or (1), respectively.
- *
- * If `y == 0', then (2) contributes 0, as it should.  However,
- * in some computer environments, for a reason I cannot understand,
- * `a >> b' means `a >> (b % N)'.  This means `num.blk[x-1] >> (N - y)'
- * will return `num.blk[x-1]' instead of the desired 0 when `y == 0';
- * the test `y == 0' handles this case specially.
- */
-inline BigUnsigned::Blk getShiftedBlock(const BigUnsigned &num,
-	BigUnsigned::Index x, unsigned int y) {
-	BigUnsigned::Blk part1 = (x == 0 || y == 0) ? 0 : (num.blk[x - 1] >> (BigUnsigned::N - y));
-	BigUnsigned::Blk part2 = (x == num.len) ? 0 : (num.blk[x] << y);
-	return part1 | part2;
-}
-
 void BigUnsigned::multiply(const BigUnsigned &a, const BigUnsigned &b) {
 	DTRT_ALIASED(this == &a || this == &b, multiply(a, b));
 	// If either a or b is zero, set to zero.
@@ -304,77 +221,40 @@ void BigUnsigned::multiply(const BigUnsigned &a, const BigUnsigned &b) {
 		len = 0;
 		return;
 	}
-	/*
-	 * Overall method:
-	 *
-	 * Set this = 0.
-	 * For each 1-bit of `a' (say the `i2'th bit of block `i'):
-	 *    Add `b << (i blocks and i2 bits)' to *this.
-	 */
-	// Variables for the calculation
-	Index i, j, k;
-	unsigned int i2;
-	Blk temp;
-	bool carryIn, carryOut;
-	// Set preliminary length and make room
+	/* Word-level multiplication of the block arrays; see
+	 * BigUnsignedMultiply.cpp for the schoolbook and Karatsuba methods. */
 	len = a.len + b.len;
 	allocate(len);
-	// Zero out this object
-	for (i = 0; i < len; i++)
-		blk[i] = 0;
-	// For each block of the first number...
-	for (i = 0; i < a.len; i++) {
-		// For each 1-bit of that block...
-		for (i2 = 0; i2 < N; i2++) {
-			if ((a.blk[i] & (Blk(1) << i2)) == 0)
-				continue;
-			/*
-			 * Add b to this, shifted left i blocks and i2 bits.
-			 * j is the index in b, and k = i + j is the index in this.
-			 *
-			 * `getShiftedBlock', a short inline function defined above,
-			 * is now used for the bit handling.  It replaces the more
-			 * complex `bHigh' code, in which each run of the loop dealt
-			 * immediately with the low bits and saved the high bits to
-			 * be picked up next time.  The last run of the loop used to
-			 * leave leftover high bits, which were handled separately.
-			 * Instead, this loop runs an additional time with j == b.len.
-			 * These changes were made on 2005.01.11.
-			 */
-			for (j = 0, k = i, carryIn = false; j <= b.len; j++, k++) {
-				/*
-				 * The body of this loop is very similar to the body of the first loop
-				 * in `add', except that this loop does a `+=' instead of a `+'.
-				 */
-				temp = blk[k] + getShiftedBlock(b, j, i2);
-				carryOut = (temp < blk[k]);
-				if (carryIn) {
-					temp++;
-					carryOut |= (temp == 0);
-				}
-				blk[k] = temp;
-				carryIn = carryOut;
-			}
-			// No more extra iteration to deal with `bHigh'.
-			// Roll-over a carry as necessary.
-			for (; carryIn; k++) {
-				blk[k]++;
-				carryIn = (blk[k] == 0);
-			}
-		}
-	}
+	// x * x, as in ans *= ans, can share the work on its two operands.
+	if (&a == &b)
+		BigUnsignedKernels::square(blk, a.blk, a.len);
+	else
+		BigUnsignedKernels::multiply(blk, a.blk, a.len, b.blk, b.len);
 	// Zap possible leading zero
 	if (blk[len - 1] == 0)
 		len--;
 }
 
+void BigUnsigned::square(const BigUnsigned &a) {
+	DTRT_ALIASED(this == &a, square(a));
+	if (a.len == 0) {
+		len = 0;
+		return;
+	}
+	len = 2 * a.len;
+	allocate(len);
+	BigUnsignedKernels::square(blk, a.blk, a.len);
+	if (blk[len - 1] == 0)
+		len--;
+}
+
 /*
  * DIVISION WITH REMAINDER
- * This monstrous function mods *this by the given divisor b while storing the
+ * This function mods *this by the given divisor b while storing the
  * quotient in the given object q; at the end, *this contains the remainder.
  * The seemingly bizarre pattern of inputs and outputs was chosen so that the
- * function copies as little as possible (since it is implemented by repeated
- * subtraction of multiples of b from *this).
+ * function copies as little as possible (the remainder is computed in place
+ * in *this).
  * 
  * "modWithQuotient" might be a better name for this function, but I would
  * rather not change the name now.
@@ -420,121 +300,47 @@ void BigUnsigned::divideWithRemainder(const BigUnsigned &b, BigUnsigned &q) {
 
 	// At this point we know (*this).len >= b.len > 0.  (Whew!)
 
-	/*
-	 * Overall method:
-	 *
-	 * For each appropriate i and i2, decreasing:
-	 *    Subtract (b << (i blocks and i2 bits)) from *this, storing the
-	 *      result in subtractBuf.
-	 *    If the subtraction succeeds with a nonnegative result:
-	 *        Turn on bit i2 of block i of the quotient q.
-	 *        Copy subtractBuf back into *this.
-	 *    Otherwise bit i2 of block i remains off, and *this is unchanged.
-	 * 
-	 * Eventually q will contain the entire quotient, and *this will
-	 * be left with the remainder.
-	 *
-	 * subtractBuf[x] corresponds to blk[x], not blk[x+i], since 2005.01.11.
-	 * But on a single iteration, we don't touch the i lowest blocks of blk
-	 * (and don't use those of subtractBuf) because these blocks are
-	 * unaffected by the subtraction: we are subtracting
-	 * (b << (i blocks and i2 bits)), which ends in at least `i' zero
-	 * blocks. */
-	// Variables for the calculation
-	Index i, j, k;
-	unsigned int i2;
-	Blk temp;
-	bool borrowIn, borrowOut;
+	// Division by a single block, the most common case, takes one pass.
+	if (b.len == 1) {
+		q.len = len;
+		q.allocate(q.len);
+		Blk r = BigUnsignedKernels::divWord(q.blk, blk, len, b.blk[0]);
+		blk[0] = r;
+		len = (r == 0) ? 0 : 1;
+		q.zapLeadingZeros();
+		return;
+	}
 
 	/*
-	 * Make sure we have an extra zero block just past the value.
+	 * Overall method: Knuth's Algorithm D (TAOCP vol. 2, 4.3.1).
 	 *
-	 * When we attempt a subtraction, we might shift `b' so
-	 * its first block begins a few bits left of the dividend,
-	 * and then we'll try to compare these extra bits with
-	 * a nonexistent block to the left of the dividend.  The
-	 * extra zero block ensures sensible behavior; we need
-	 * an extra block in `subtractBuf' for exactly the same reason.
+	 * Shift b and *this left until the top bit of b is set, so that each
+	 * block of the quotient can be estimated from the leading blocks.  The
+	 * shifted *this gets an extra top block.  The quotient blocks are
+	 * produced from the most significant down, each time subtracting that
+	 * multiple of b from *this, which leaves the shifted remainder in the
+	 * low b.len blocks; shifting it back gives the remainder.
 	 */
-	Index origLen = len; // Save real length.
+	unsigned int shift = BigUnsignedKernels::countLeadingZeros(b.blk[b.len - 1]);
+	BlockMemory::ScopedArray<Blk> normalized(b.len);
+	Blk *v = normalized.get();
+	BigUnsignedKernels::shiftLeftBits(v, b.blk, b.len, shift);
+
+	Index origLen = len;
 	/* To avoid an out-of-bounds access in case of reallocation, allocate
 	 * first and then increment the logical length. */
 	allocateAndCopy(len + 1);
 	len++;
-	blk[origLen] = 0; // Zero the added block.
-
-	// subtractBuf holds part of the result of a subtraction; see above.
-	Blk *subtractBuf = new Blk[len];
+	blk[origLen] = BigUnsignedKernels::shiftLeftBits(blk, blk, origLen, shift);
 
-	// Set preliminary length for quotient and make room
 	q.len = origLen - b.len + 1;
 	q.allocate(q.len);
-	// Zero out the quotient
-	for (i = 0; i < q.len; i++)
-		q.blk[i] = 0;
-
-	// For each possible left-shift of b in blocks...
-	i = q.len;
-	while (i > 0) {
-		i--;
-		// For each possible left-shift of b in bits...
-		// (Remember, N is the number of bits in a Blk.)
-		q.blk[i] = 0;
-		i2 = N;
-		while (i2 > 0) {
-			i2--;
-			/*
-			 * Subtract b, shifted left i blocks and i2 bits, from *this,
-			 * and store the answer in subtractBuf.  In the for loop, `k == i + j'.
-			 *
-			 * Compare this to the middle section of `multiply'.  They
-			 * are in many ways analogous.  See especially the discussion
-			 * of `getShiftedBlock'.
-			 */
-			for (j = 0, k = i, borrowIn = false; j <= b.len; j++, k++) {
-				temp = blk[k] - getShiftedBlock(b, j, i2);
-				borrowOut = (temp > blk[k]);
-				if (borrowIn) {
-					borrowOut |= (temp == 0);
-					temp--;
-				}
-				// Since 2005.01.11, indices of `subtractBuf' directly match those of `blk', so use `k'.
-				subtractBuf[k] = temp; 
-				borrowIn = borrowOut;
-			}
-			// No more extra iteration to deal with `bHigh'.
-			// Roll-over a borrow as necessary.
-			for (; k < origLen && borrowIn; k++) {
-				borrowIn = (blk[k] == 0);
-				subtractBuf[k] = blk[k] - 1;
-			}
-			/*
-			 * If the subtraction was performed successfully (!borrowIn),
-			 * set bit i2 in block i of the quotient.
-			 *
-			 * Then, copy the portion of subtractBuf filled by the subtraction
-			 * back to *this.  This portion starts with block i and ends--
-			 * where?  Not necessarily at block `i + b.len'!  Well, we
-			 * increased k every time we saved a block into subtractBuf, so
-			 * the region of subtractBuf we copy is just [i, k).
-			 */
-			if (!borrowIn) {
-				q.blk[i] |= (Blk(1) << i2);
-				while (k > i) {
-					k--;
-					blk[k] = subtractBuf[k];
-				}
-			} 
-		}
-	}
-	// Zap possible leading zero in quotient
-	if (q.blk[q.len - 1] == 0)
-		q.len--;
-	// Zap any/all leading zeros in remainder
+	BigUnsignedKernels::divideNormalized(q.blk, blk, len, v, b.len);
+
+	BigUnsignedKernels::shiftRightBits(blk, blk, b.len, shift);
+	len = b.len;
 	zapLeadingZeros();
-	// Deallocate subtractBuf.
-	// (Thanks to Brad Spencer for noticing my accidental omission of this!)
-	delete [] subtractBuf;
+	q.zapLeadingZeros();
 }
 
 /* BITWISE OPERATORS
@@ -603,16 +409,19 @@ void BigUnsigned::bitShiftLeft(const BigUnsigned &a, int b) {
 			return;
 		}
 	}
+	if (a.len == 0) {
+		len = 0;
+		return;
+	}
 	Index shiftBlocks = b / N;
 	unsigned int shiftBits = b % N;
 	// + 1: room for high bits nudged left into another block
 	len = a.len + shiftBlocks + 1;
 	allocate(len);
-	Index i, j;
-	for (i = 0; i < shiftBlocks; i++)
+	for (Index i = 0; i < shiftBlocks; i++)
 		blk[i] = 0;
-	for (j = 0, i = shiftBlocks; j <= a.len; j++, i++)
-		blk[i] = getShiftedBlock(a, j, shiftBits);
+	blk[len - 1] = BigUnsignedKernels::shiftLeftBits(blk + shiftBlocks,
+			a.blk, a.len, shiftBits);
 	// Zap possible leading zero
 	if (blk[len - 1] == 0)
 		len--;
@@ -629,30 +438,159 @@ void BigUnsigned::bitShiftRight(const BigUnsigned &a, int b) {
 			return;
 		}
 	}
-	// This calculation is wacky, but expressing the shift as a left bit shift
-	// within each block lets us use getShiftedBlock.
-	Index rightShiftBlocks = (b + N - 1) / N;
-	unsigned int leftShiftBits = N * rightShiftBlocks - b;
-	// Now (N * rightShiftBlocks - leftShiftBits) == b
-	// and 0 <= leftShiftBits < N.
-	if (rightShiftBlocks >= a.len + 1) {
-		// All of a is guaranteed to be shifted off, even considering the left
-		// bit shift.
+	Index shiftBlocks = b / N;
+	if (shiftBlocks >= a.len) {
+		// All of a is shifted off.
 		len = 0;
 		return;
 	}
-	// Now we're allocating a positive amount.
-	// + 1: room for high bits nudged left into another block
-	len = a.len + 1 - rightShiftBlocks;
+	len = a.len - shiftBlocks;
 	allocate(len);
-	Index i, j;
-	for (j = rightShiftBlocks, i = 0; j <= a.len; j++, i++)
-		blk[i] = getShiftedBlock(a, j, leftShiftBits);
+	BigUnsignedKernels::shiftRightBits(blk, a.blk + shiftBlocks, len, b % N);
 	// Zap possible leading zero
 	if (blk[len - 1] == 0)
 		len--;
 }
 
+// IN-PLACE ASSIGNMENT OPERATORS
+
+/* Unlike the put-here operations, these work directly in blk, so they only
+ * allocate when the result outgrows the capacity. */
+
+void BigUnsigned::operator +=(const BigUnsigned &x) {
+	if (x.len == 0)
+		return;
+	if (this == &x) {
+		operator <<=(1);
+		return;
+	}
+	using namespace BigUnsignedKernels;
+	Index n = (len >= x.len) ? len : x.len;
+	allocateAndCopy(n);
+	for (Index i = len; i < n; i++)
+		blk[i] = 0;
+	Blk carry = addN(blk, blk, x.blk, x.len);
+	carry = addWord(blk + x.len, blk + x.len, n - x.len, carry);
+	len = n;
+	if (carry != 0) {
+		allocateAndCopy(len + 1);
+		blk[len++] = carry;
+	}
+}
+
+void BigUnsigned::operator -=(const BigUnsigned &x) {
+	// Check first so that a failed subtraction leaves *this alone.
+	if (compareTo(x) == less)
+		throw "BigUnsigned::operator -=: Negative result in unsigned calculation";
+	if (x.len == 0)
+		return;
+	using namespace BigUnsignedKernels;
+	Blk borrow = subN(blk, blk, x.blk, x.len);
+	subWord(blk + x.len, blk + x.len, len - x.len, borrow);
+	zapLeadingZeros();
+}
+
+// MULTIPLY-ACCUMULATE
+
+bool BigUnsigned::mulAccumulate(const BigUnsigned &a, const BigUnsigned &b,
+		bool subtract) {
+	if (a.len == 0 || b.len == 0)
+		return false;
+	using namespace BigUnsignedKernels;
+	// x is the longer operand; a one-block y needs no product array.
+	const BigUnsigned *x = &a, *y = &b;
+	if (x->len < y->len) {
+		x = &b;
+		y = &a;
+	}
+	Index pn;
+	BlockMemory::ScopedArray<Blk> productArray;
+	Blk *product = NULL;
+	if (y->len == 1)
+		pn = x->len;
+	else {
+		// The product is formed before *this, which may be a or b, changes.
+		pn = a.len + b.len;
+		product = productArray.allocate(pn);
+		if (&a == &b)
+			BigUnsignedKernels::square(product, a.blk, a.len);
+		else
+			BigUnsignedKernels::multiply(product, a.blk, a.len, b.blk, b.len);
+	}
+	Blk w = y->blk[0];
+
+	// Room for the larger of the two and a carry.
+	Index n = ((len > pn) ? len : pn) + 1;
+	allocateAndCopy(n);
+	for (Index i = len; i < n; i++)
+		blk[i] = 0;
+	/* If x is *this, x->blk is now blk, and the word kernels read each
+	 * block before they write it. */
+	Blk carry;
+	if (product == NULL)
+		carry = subtract ? subMulWord(blk, x->blk, pn, w)
+			: addMulWord(blk, x->blk, pn, w);
+	else
+		carry = subtract ? subN(blk, blk, product, pn)
+			: addN(blk, blk, product, pn);
+	bool flipped = false;
+	if (!subtract)
+		addWord(blk + pn, blk + pn, n - pn, carry);
+	else if (subWord(blk + pn, blk + pn, n - pn, carry) != 0) {
+		// The difference went below zero; take its magnitude.
+		negateN(blk, n);
+		flipped = true;
+	}
+	len = n;
+	zapLeadingZeros();
+	return flipped;
+}
+
+void BigUnsigned::addMul(const BigUnsigned &a, const BigUnsigned &b) {
+	mulAccumulate(a, b, false);
+}
+
+void BigUnsigned::subMul(const BigUnsigned &a, const BigUnsigned &b) {
+	if (mulAccumulate(a, b, true)) {
+		len = 0;
+		throw "BigUnsigned::subMul: Negative result in unsigned calculation";
+	}
+}
+
+void BigUnsigned::operator <<=(int b) {
+	if (b < 0 || len == 0) {
+		bitShiftLeft(*this, b);
+		return;
+	}
+	Index shiftBlocks = b / N;
+	unsigned int shiftBits = b % N;
+	allocateAndCopy(len + shiftBlocks + 1);
+	// Move the blocks up, from the top down, then clear the vacated ones.
+	Blk out = BigUnsignedKernels::shiftLeftBits(blk + shiftBlocks, blk,
+			len, shiftBits);
+	for (Index i = 0; i < shiftBlocks; i++)
+		blk[i] = 0;
+	len += shiftBlocks;
+	if (out != 0)
+		blk[len++] = out;
+}
+
+void BigUnsigned::operator >>=(int b) {
+	if (b < 0) {
+		bitShiftRight(*this, b);
+		return;
+	}
+	Index shiftBlocks = b / N;
+	if (shiftBlocks >= len) {
+		len = 0;
+		return;
+	}
+	len -= shiftBlocks;
+	// Move the blocks down, from the bottom up.
+	BigUnsignedKernels::shiftRightBits(blk, blk + shiftBlocks, len, b % N);
+	zapLeadingZeros();
+}
+
 // INCREMENT/DECREMENT OPERATORS
 
 // Prefix increment
@@ -3,6 +3,12 @@
 
 #include "NumberlikeArray.hh"
 
+// See BigIntegerExpression.hh.
+class BigIntegerTerm;
+template <unsigned int Terms> class BigIntegerSum;
+// See BigUnsignedDivisor.hh.
+class BigUnsignedDivisor;
+
 /* A BigUnsigned object represents a nonnegative integer of size limited only by
  * available memory.  BigUnsigneds support most mathematical operators and can
  * be converted to and from most primitive integer types.
@@ -44,6 +50,25 @@ public:
 		NumberlikeArray<Blk>::operator =(x);
 	}
 
+	/* Move constructor and assignment.  These hand over the block array
+	 * instead of copying it, so returning a result by value is cheap. */
+	BigUnsigned(BigUnsigned &&x) noexcept
+		: NumberlikeArray<Blk>(std::move(x)) {}
+	void operator=(BigUnsigned &&x) noexcept {
+		NumberlikeArray<Blk>::operator =(std::move(x));
+	}
+
+	/* Evaluates a fused sum of products straight into this number's block
+	 * array; throws an exception if the sum is negative.  See
+	 * BigIntegerExpression.hh. */
+	template <unsigned int Terms>
+	void operator=(const BigIntegerSum<Terms> &x);
+
+	// Exchanges the values (and block arrays) of *this and x.
+	void swap(BigUnsigned &x) noexcept {
+		NumberlikeArray<Blk>::swap(x);
+	}
+
 	// Constructor that copies from a given array of blocks.
 	BigUnsigned(const Blk *b, Index blen) : NumberlikeArray<Blk>(b, blen) {
 		// Eliminate any leading zeros we may have been passed.
@@ -148,6 +173,9 @@ public:
 	 * Example:
 	 *     BigInteger a(1), b(1);
 	 *     a += b;
+	 * +=, -=, <<= and >>= work in the receiver's own block array, which
+	 * only grows when the result needs more room, so a running sum stops
+	 * allocating once it has reached its final size.
 	 *
 	 * (3) Copy-less operations: `add', `subtract', etc.
 	 * These named methods take operands as arguments and store the result
@@ -174,10 +202,13 @@ public:
 
 	// COPY-LESS OPERATIONS
 
-	// These 8: Arguments are read-only operands, result is saved in *this.
+	// These 9: Arguments are read-only operands, result is saved in *this.
 	void add(const BigUnsigned &a, const BigUnsigned &b);
 	void subtract(const BigUnsigned &a, const BigUnsigned &b);
 	void multiply(const BigUnsigned &a, const BigUnsigned &b);
+	/* a * a, which takes about half the block products of multiply.
+	 * ans.square(ans) is the in-place square. */
+	void square(const BigUnsigned &a);
 	void bitAnd(const BigUnsigned &a, const BigUnsigned &b);
 	void bitOr(const BigUnsigned &a, const BigUnsigned &b);
 	void bitXor(const BigUnsigned &a, const BigUnsigned &b);
@@ -193,6 +224,10 @@ public:
 	 * `a.divideWithRemainder(b, a)' throws an exception: it doesn't make
 	 * sense to write quotient and remainder into the same variable. */
 	void divideWithRemainder(const BigUnsigned &b, BigUnsigned &q);
+	/* The same by a divisor prepared for repeated use, which from about a
+	 * hundred blocks up takes two multiplications instead of a long
+	 * division (BigUnsignedDivisor.hh). */
+	void divideWithRemainder(const BigUnsignedDivisor &b, BigUnsigned &q);
 
 	/* `divide' and `modulo' are no longer offered.  Use
 	 * `divideWithRemainder' instead. */
@@ -223,6 +258,24 @@ public:
 	void operator <<=(int b);
 	void operator >>=(int b);
 
+	/* MULTIPLY-ACCUMULATE
+	 * `r.addMul(a, b)' is like `r += a * b' and `r.subMul(a, b)' like
+	 * `r -= a * b', but they add the product into r's own block array: a
+	 * product by a one-block number is accumulated a block at a time, and
+	 * a longer one goes through a single scratch array.  r may be a or b,
+	 * with no copy.  subMul throws an exception if the result would be
+	 * negative, leaving r zero, as subtract does. */
+	void addMul(const BigUnsigned &a, const BigUnsigned &b);
+	void subMul(const BigUnsigned &a, const BigUnsigned &b);
+protected:
+	/* Adds a * b to *this, or with subtract, replaces *this by
+	 * |*this - a * b| and returns whether a * b was the larger. */
+	bool mulAccumulate(const BigUnsigned &a, const BigUnsigned &b,
+			bool subtract);
+	// Which BigInteger's addMul and subMul use.
+	friend class BigInteger;
+public:
+
 	/* INCREMENT/DECREMENT OPERATORS
 	 * To discourage messy coding, these do not return *this, so prefix
 	 * and postfix behave the same. */
@@ -231,15 +284,20 @@ public:
 	void operator --(   );
 	void operator --(int);
 
-	// Helper function that needs access to BigUnsigned internals
-	friend Blk getShiftedBlock(const BigUnsigned &num, Index x,
-			unsigned int y);
-
 	// See BigInteger.cc.
 	template <class X>
 	friend X convertBigUnsignedToPrimitiveAccess(const BigUnsigned &a);
+
+	// Accumulates into the block array; see BigIntegerExpression.cpp.
+	friend class BigIntegerTerm;
 };
 
+/* Found by argument-dependent lookup, so generic code that swaps two
+ * BigUnsigneds exchanges their arrays instead of copying them. */
+inline void swap(BigUnsigned &a, BigUnsigned &b) noexcept {
+	a.swap(b);
+}
+
 /* Implementing the return-by-value and assignment operators in terms of the
  * copy-less operations.  The copy-less operations are responsible for making
  * any necessary temporary copies to work around aliasing. */
@@ -299,12 +357,6 @@ inline BigUnsigned BigUnsigned::operator >>(int b) const {
 	return ans;
 }
 
-inline void BigUnsigned::operator +=(const BigUnsigned &x) {
-	add(*this, x);
-}
-inline void BigUnsigned::operator -=(const BigUnsigned &x) {
-	subtract(*this, x);
-}
 inline void BigUnsigned::operator *=(const BigUnsigned &x) {
 	multiply(*this, x);
 }
@@ -315,7 +367,7 @@ inline void BigUnsigned::operator /=(const BigUnsigned &x) {
 	BigUnsigned q;
 	divideWithRemainder(x, q);
 	// *this contains the remainder, but we overwrite it with the quotient.
-	*this = q;
+	swap(q);
 }
 inline void BigUnsigned::operator %=(const BigUnsigned &x) {
 	if (x.isZero()) throw "BigUnsigned::operator %=: division by zero";
@@ -332,12 +384,6 @@ inline void BigUnsigned::operator |=(const BigUnsigned &x) {
 inline void BigUnsigned::operator ^=(const BigUnsigned &x) {
 	bitXor(*this, x);
 }
-inline void BigUnsigned::operator <<=(int b) {
-	bitShiftLeft(*this, b);
-}
-inline void BigUnsigned::operator >>=(int b) {
-	bitShiftRight(*this, b);
-}
 
 /* Templates for conversions of BigUnsigned to and from primitive integers.
  * BigInteger.cc needs to instantiate convertToPrimitive, and the uses in
@@ -357,9 +403,7 @@ void BigUnsigned::initFromPrimitive(X x) {
 	if (x == 0)
 		; // NumberlikeArray already initialized us to zero.
 	else {
-		// Create a single block.  blk is NULL; no need to delete it.
-		cap = 1;
-		blk = new Blk[1];
+		// A single block, which fits in the inline storage.
 		len = 1;
 		blk[0] = Blk(x);
 	}
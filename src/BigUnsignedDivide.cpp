@@ -0,0 +1,77 @@
+#include "BigUnsignedKernels.hh"
+
+/* Block-array division for BigUnsigned::divideWithRemainder.
+ *
+ * Both routines work on a normalized divisor (top bit set), which keeps
+ * every quotient-block estimate within two of the truth.  Each quotient
+ * block comes from one two-by-one division done as a multiplication by the
+ * precomputed reciprocal of the divisor's top block. */
+
+namespace BigUnsignedKernels {
+
+	/* Shifts the dividend left on the fly, so a single-block divisor costs
+	 * one pass over a with no copy. */
+	Blk divWord(Blk *q, const Blk *a, Index n, Blk d) {
+		unsigned int s = countLeadingZeros(d);
+		Blk dn = d << s;
+		Blk v = reciprocal(dn);
+		Blk r = 0;
+		if (s == 0) {
+			for (Index i = n; i > 0; i--)
+				q[i - 1] = divNormalized(r, a[i - 1], dn, v, r);
+			return r;
+		}
+		r = a[n - 1] >> (N - s);
+		for (Index i = n; i > 0; i--) {
+			Blk lo = a[i - 1] << s;
+			if (i > 1)
+				lo |= a[i - 2] >> (N - s);
+			q[i - 1] = divNormalized(r, lo, dn, v, r);
+		}
+		return r >> s;
+	}
+
+	/* Quotient block j is estimated from the top two blocks of the current
+	 * partial remainder over the top block of v, corrected with the next
+	 * block of each (step D3), after which v times the estimate is
+	 * subtracted.  The estimate is then at most one too big, which the
+	 * rare add-back step (D6) repairs. */
+	void divideNormalized(Blk *q, Blk *u, Index un, const Blk *v, Index n) {
+		Blk d1 = v[n - 1], d0 = v[n - 2];
+		Blk inverse = reciprocal(d1);
+		Index j = un - n;
+		while (j > 0) {
+			j--;
+			Blk u2 = u[j + n], u1 = u[j + n - 1], u0 = u[j + n - 2];
+			Blk qhat, rhat;
+			bool rhatOverflow;
+			if (u2 >= d1) {
+				// u2 == d1: the quotient block is B - 1 or B - 2.
+				qhat = ~Blk(0);
+				rhat = u1 + d1;
+				rhatOverflow = (rhat < u1);
+			} else {
+				qhat = divNormalized(u2, u1, d1, inverse, rhat);
+				rhatOverflow = false;
+			}
+			while (!rhatOverflow) {
+				Blk ph;
+				Blk pl = mulWide(qhat, d0, ph);
+				if (ph < rhat || (ph == rhat && pl <= u0))
+					break;
+				qhat--;
+				rhat += d1;
+				rhatOverflow = (rhat < d1);
+			}
+
+			Blk borrow = subMulWord(u + j, v, n, qhat);
+			Blk top = u[j + n];
+			u[j + n] = top - borrow;
+			if (top < borrow) {
+				qhat--;
+				u[j + n] += addN(u + j, u + j, v, n);
+			}
+			q[j] = qhat;
+		}
+	}
+}
@@ -0,0 +1,157 @@
+#include "BigUnsignedDivisor.hh"
+#include "BigUnsignedKernels.hh"
+#include "BlockArena.hh"
+
+BigUnsignedDivisor::Index BigUnsignedDivisor::barrettThreshold = 128;
+BigUnsignedDivisor::Index BigUnsignedDivisor::newtonThreshold = 1024;
+
+namespace {
+	typedef BigUnsignedDivisor::Blk Blk;
+	typedef BigUnsignedDivisor::Index Index;
+
+	/* One step of Barrett's method: reduces the wn-block window x, with
+	 * k <= wn <= 2k, modulo the k-block m, given mu = floor(B^(2k) / m) in
+	 * mun blocks.  Leaves the remainder in x[0 .. k) with zeros above it
+	 * and adds the quotient into q[0 .. qn), whose blocks past qn it would
+	 * leave zero anyway.  scratch holds 5k + 6 blocks.
+	 *
+	 * The estimate floor(floor(x / B^(k - 1)) mu / B^(k + 1)) is at most 2
+	 * below the quotient, so x minus it times m is below 3m < B^(k + 1) and
+	 * needs only the low k + 1 blocks of each side. */
+	void barrettStep(Blk *x, Index wn, const Blk *m, Index k, const Blk *mu,
+			Index mun, Blk *q, Index qn, Blk *scratch) {
+		using namespace BigUnsignedKernels;
+		const Blk *top = x + (k - 1);
+		Index topLen = wn - (k - 1);
+		Blk *estimate = scratch;
+		multiply(estimate, top, topLen, mu, mun);
+		Index productLen = topLen + mun;
+		Blk *r = estimate + productLen;
+		Blk *p = r + (k + 1);
+		// The estimate is the product without its low k + 1 blocks.
+		Blk *e = estimate + (k + 1);
+		Index en = (productLen > k + 1) ? productLen - (k + 1) : 0;
+		while (en > 0 && e[en - 1] == 0)
+			en--;
+
+		// r = x - e m modulo B^(k + 1)
+		Index i;
+		for (i = 0; i < k + 1 && i < wn; i++)
+			r[i] = x[i];
+		for (; i < k + 1; i++)
+			r[i] = 0;
+		if (en > 0) {
+			multiply(p, e, en, m, k);
+			Index pn = (en + k < k + 1) ? en + k : k + 1;
+			Blk borrow = subN(r, r, p, pn);
+			subWord(r + pn, r + pn, k + 1 - pn, borrow);
+		}
+		Blk extra = 0;
+		while (r[k] != 0 || compareN(r, m, k) >= 0) {
+			r[k] -= subN(r, r, m, k);
+			extra++;
+		}
+
+		for (i = 0; i < k; i++)
+			x[i] = r[i];
+		for (; i < wn; i++)
+			x[i] = 0;
+		if (en > qn)
+			en = qn;
+		Blk carry = addN(q, q, e, en);
+		addWord(q + en, q + en, qn - en, carry);
+		addWord(q, q, qn, extra);
+	}
+}
+
+BigUnsignedDivisor::BigUnsignedDivisor(const BigUnsigned &divisor)
+		: divisor(divisor), k(divisor.getLength()) {
+	if (divisor.isZero())
+		throw "BigUnsignedDivisor: The divisor must be nonzero";
+	if (k >= barrettThreshold)
+		reciprocal = reciprocalOf(divisor);
+}
+
+/* The reciprocal of the top h = n / 2 + 2 blocks of d, shifted up by the
+ * n - h blocks dropped, is within a relative B^(1 - h) of mu, and one
+ * Newton step squares that, leaving x within a few units of mu: below
+ * B^(n + 1) times B^(2 - 2h) <= B^-1 plus the truncations.  The loops at
+ * the end take those off and make it exact. */
+BigUnsigned BigUnsignedDivisor::reciprocalOf(const BigUnsigned &d) {
+	Index n = d.getLength();
+	int shift = int(BigUnsigned::N * 2 * n);
+	BigUnsigned power(1);
+	power <<= shift;
+	if (n < newtonThreshold) {
+		BigUnsigned q;
+		power.divideWithRemainder(d, q);
+		return q;
+	}
+
+	Index h = n / 2 + 2;
+	int dropped = int(BigUnsigned::N * (n - h));
+	BigUnsigned x = reciprocalOf(d >> dropped) << dropped;
+	BigUnsigned dx = d * x, t;
+	// x = x + x (B^(2n) - d x) / B^(2n), with the sign handled apart
+	if (dx <= power) {
+		t.multiply(x, power - dx);
+		t >>= shift;
+		x += t;
+	} else {
+		t.multiply(x, dx - power);
+		t >>= shift;
+		x -= t;
+	}
+	dx.multiply(d, x);
+	while (dx > power) {
+		x -= 1;
+		dx -= d;
+	}
+	BigUnsigned rest = power - dx;
+	while (rest >= d) {
+		x += 1;
+		rest -= d;
+	}
+	return x;
+}
+
+/* Barrett's method (see BigUnsignedDivisor.hh) on windows of at most 2k
+ * blocks of *this, from the top: the first is the top 2k blocks, and each
+ * next one the remainder left by the last with the k blocks below it, so
+ * that it stays below d B^k. */
+void BigUnsigned::divideWithRemainder(const BigUnsignedDivisor &b,
+		BigUnsigned &q) {
+	if (this == &q)
+		throw "BigUnsigned::divideWithRemainder: Cannot write quotient and remainder into the same variable";
+	if (b.reciprocal.isZero()) {
+		divideWithRemainder(b.divisor, q);
+		return;
+	}
+	Index k = b.k;
+	if (len < k) {
+		q.len = 0;
+		return;
+	}
+
+	Index qn = len - k + 1;
+	q.len = qn;
+	q.allocate(qn);
+	for (Index i = 0; i < qn; i++)
+		q.blk[i] = 0;
+	BlockMemory::ScopedArray<Blk> scratchArray(5 * k + 6);
+	Blk *scratch = scratchArray.get();
+	Index j = (len > 2 * k) ? len - 2 * k : 0, wn = len - j;
+	for (;;) {
+		barrettStep(blk + j, wn, b.divisor.blk, k, b.reciprocal.blk,
+				b.reciprocal.len, q.blk + j, qn - j, scratch);
+		if (j == 0)
+			break;
+		Index next = (j > k) ? j - k : 0;
+		wn = j + k - next;
+		j = next;
+	}
+
+	len = k;
+	zapLeadingZeros();
+	q.zapLeadingZeros();
+}
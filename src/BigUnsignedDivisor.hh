@@ -0,0 +1,55 @@
+#ifndef BIGUNSIGNEDDIVISOR_H
+#define BIGUNSIGNEDDIVISOR_H
+
+#include "BigUnsigned.hh"
+
+/* A divisor d of k blocks prepared for repeated division, as in
+ *     BigUnsignedDivisor m(modulus);
+ *     x.divideWithRemainder(m, q);
+ *
+ * Long division costs about k block products per quotient block whatever
+ * the divisor.  From barrettThreshold blocks up the divisor keeps its
+ * reciprocal mu = floor(B^(2k) / d), and Barrett's method takes the
+ * quotient of a 2k-block x from the top blocks of x times mu and the
+ * remainder from x minus that quotient times d, short by at most 2 d: two
+ * multiplications, which the subquadratic methods make cheaper than the
+ * division.  Longer dividends are reduced 2k blocks at a time from the top.
+ * Smaller divisors keep to long division.
+ *
+ * The reciprocal is worked out once, by long division for fewer than
+ * newtonThreshold blocks and above that by Newton's iteration
+ * x = x + x (B^(2k) - d x) / B^(2k), which doubles the correct blocks of x
+ * per step, starting from the reciprocal of the top half of d. */
+class BigUnsignedDivisor {
+
+public:
+	typedef BigUnsigned::Blk Blk;
+	typedef BigUnsigned::Index Index;
+
+	/* Divisors with at least this many blocks divide by Barrett's method,
+	 * and reciprocals with at least newtonThreshold blocks are found by
+	 * Newton's iteration; that one must be at least 8.  See
+	 * bench/divisor_bench.cpp. */
+	static Index barrettThreshold;
+	static Index newtonThreshold;
+
+protected:
+	BigUnsigned divisor;
+	// Number of blocks in the divisor
+	Index k;
+	// floor(B^(2k) / divisor), or zero below barrettThreshold
+	BigUnsigned reciprocal;
+
+	friend class BigUnsigned;
+
+public:
+	// Throws an exception if the divisor is zero.
+	explicit BigUnsignedDivisor(const BigUnsigned &divisor);
+
+	const BigUnsigned &getDivisor() const { return divisor; }
+
+	// floor(B^(2n) / d) for a d of n blocks
+	static BigUnsigned reciprocalOf(const BigUnsigned &d);
+};
+
+#endif
@@ -1,4 +1,8 @@
 #include "BigUnsignedInABase.hh"
+#include "BigUnsignedDivisor.hh"
+#include "BigUnsignedKernels.hh"
+#include "BlockArena.hh"
+#include <vector>
 
 BigUnsignedInABase::BigUnsignedInABase(const Digit *d, Index l, Base base)
 	: NumberlikeArray<Digit>(d, l), base(base) {
@@ -27,6 +31,167 @@ namespace {
 	unsigned int ceilingDiv(unsigned int a, unsigned int b) {
 		return (a + b - 1) / b;
 	}
+
+	typedef BigUnsigned::Blk Blk;
+	typedef BigUnsigned::Index Index;
+	typedef BigUnsignedInABase::Digit Digit;
+	typedef BigUnsignedInABase::Base Base;
+
+	/* Numbers of at least this many blocks are split in half by divide and
+	 * conquer; smaller ones are converted a block division at a time. */
+	const Index splitThreshold = 40;
+
+	/* The largest power of the base that fits in a block.  One division of
+	 * the whole number by it peels off that many digits at once (19 of them
+	 * for base 10 and 64-bit blocks). */
+	struct Chunk {
+		Base base;
+		Blk power;
+		unsigned int digits;
+
+		Chunk(Base base) : base(base), power(base), digits(1) {
+			while (power <= ~Blk(0) / base) {
+				power *= base;
+				digits++;
+			}
+		}
+	};
+
+	/* The powers chunk.power^(2^i), i = 0, 1, ..., by which divide and
+	 * conquer splits a number.  They are squared as needed and kept for the
+	 * next conversion in the same base, along with each one prepared as a
+	 * divisor, since writeDigits divides by the same power at every split
+	 * of a level.  Each thread keeps its own table, so no locking is
+	 * needed.  A reference into the table is good only until the next call
+	 * to power() or divisor().  The entries outlive any ScopedBlockArena a
+	 * conversion runs in, so they are built on the heap. */
+	class PowerTable {
+		Base base;
+		std::vector<BigUnsigned> powers;
+		std::vector<BigUnsignedDivisor> divisors;
+
+	public:
+		PowerTable() : base(0) {}
+
+		const BigUnsigned &power(const Chunk &chunk, Index level) {
+			if (base != chunk.base) {
+				powers.clear();
+				divisors.clear();
+				base = chunk.base;
+			}
+			if (powers.size() > level)
+				return powers[level];
+			ScopedHeapBlocks heap;
+			if (powers.empty())
+				powers.push_back(BigUnsigned(chunk.power));
+			while (powers.size() <= level) {
+				BigUnsigned square;
+				square.multiply(powers.back(), powers.back());
+				powers.push_back(square);
+			}
+			return powers[level];
+		}
+
+		const BigUnsignedDivisor &divisor(const Chunk &chunk, Index level) {
+			power(chunk, level);
+			if (divisors.size() > level)
+				return divisors[level];
+			ScopedHeapBlocks heap;
+			while (divisors.size() <= level)
+				divisors.push_back(BigUnsignedDivisor(powers[divisors.size()]));
+			return divisors[level];
+		}
+
+		static PowerTable &forThisThread() {
+			static thread_local PowerTable table;
+			return table;
+		}
+	};
+
+	/* Stores the low chunk.digits digits of r (which is below chunk.power),
+	 * least significant first, but no more than width of them. */
+	inline void splitChunk(Blk r, const Chunk &chunk, Digit *out, Index width) {
+		Index count = (chunk.digits < width) ? chunk.digits : width;
+		// A constant divisor becomes a multiplication.
+		if (chunk.base == 10)
+			for (Index k = 0; k < count; k++, r /= 10)
+				out[k] = Digit(r % 10);
+		else
+			for (Index k = 0; k < count; k++, r /= chunk.base)
+				out[k] = Digit(r % chunk.base);
+	}
+
+	/* Writes exactly width digits of x < base^width to out, least
+	 * significant first and padded with zeros.  Below splitThreshold, each
+	 * pass divides the remaining blocks by chunk.power; above it, x is split
+	 * into halves by the power in the table nearest to its square root. */
+	void writeDigits(const BigUnsigned &x, const Chunk &chunk, Digit *out,
+			Index width) {
+		Index n = x.getLength();
+		if (n < splitThreshold) {
+			BlockMemory::ScopedArray<Blk> scratch(n + 1);
+			Blk *rest = scratch.get();
+			for (Index i = 0; i < n; i++)
+				rest[i] = x.getBlock(i);
+			Index done = 0;
+			while (n > 0 && done < width) {
+				Blk r = BigUnsignedKernels::divWord(rest, rest, n, chunk.power);
+				if (rest[n - 1] == 0)
+					n--;
+				splitChunk(r, chunk, out + done, width - done);
+				done += chunk.digits;
+			}
+			for (; done < width; done++)
+				out[done] = 0;
+			return;
+		}
+
+		/* Find the largest tabulated power with at most half the blocks of
+		 * x.  It is below x, so the split is nontrivial. */
+		PowerTable &table = PowerTable::forThisThread();
+		Index half = (n + 1) / 2, level = 0;
+		while (table.power(chunk, level).getLength() * 2 - 1 <= half)
+			level++;
+		if (table.power(chunk, level).getLength() > half)
+			level--;
+
+		BigUnsigned high, low(x);
+		low.divideWithRemainder(table.divisor(chunk, level), high);
+		Index lowWidth = chunk.digits << level;
+		writeDigits(low, chunk, out, lowWidth);
+		writeDigits(high, chunk, out + lowWidth, width - lowWidth);
+	}
+
+	/* Returns the number whose base-chunk.power digits, least significant
+	 * first, are the m chunks c[0 .. m).  The mirror image of writeDigits:
+	 * Horner's rule a block at a time below splitThreshold, and above it the
+	 * high and low halves combined as high * power + low. */
+	BigUnsigned readChunks(const Blk *c, Index m, const Chunk &chunk) {
+		if (m < splitThreshold) {
+			BlockMemory::ScopedArray<Blk> scratch(m);
+			Blk *r = scratch.get();
+			Index n = 0;
+			for (Index j = m; j > 0; j--) {
+				Blk carry = BigUnsignedKernels::mulWord(r, r, n, chunk.power);
+				carry += BigUnsignedKernels::addWord(r, r, n, c[j - 1]);
+				if (carry != 0)
+					r[n++] = carry;
+			}
+			return BigUnsigned(r, n);
+		}
+
+		// The low part gets the largest power of two below m chunks.
+		Index level = 0;
+		while ((Index(2) << level) < m)
+			level++;
+		Index lowChunks = Index(1) << level;
+		BigUnsigned high = readChunks(c + lowChunks, m - lowChunks, chunk);
+		BigUnsigned low = readChunks(c, lowChunks, chunk);
+		BigUnsigned product, ans;
+		product.multiply(high, PowerTable::forThisThread().power(chunk, level));
+		ans.add(product, low);
+		return ans;
+	}
 }
 
 BigUnsignedInABase::BigUnsignedInABase(const BigUnsigned &x, Base base) {
@@ -42,32 +207,29 @@ BigUnsignedInABase::BigUnsignedInABase(const BigUnsigned &x, Base base) {
 	len = maxDigitLenOfX; // Another change to comply with `staying in bounds'.
 	allocate(len); // Get the space
 
-	BigUnsigned x2(x), buBase(base);
-	Index digitNum = 0;
-
-	while (!x2.isZero()) {
-		// Get last digit.  This is like `lastDigit = x2 % buBase, x2 /= buBase'.
-		BigUnsigned lastDigit(x2);
-		lastDigit.divideWithRemainder(buBase, x2);
-		// Save the digit.
-		blk[digitNum] = lastDigit.toUnsignedShort();
-		// Move on.  We can't run out of room: we figured it out above.
-		digitNum++;
-	}
-
-	// Save the actual length.
-	len = digitNum;
+	// Fill all of it, then drop the padding.
+	writeDigits(x, Chunk(base), blk, len);
+	zapLeadingZeros();
 }
 
 BigUnsignedInABase::operator BigUnsigned() const {
-	BigUnsigned ans(0), buBase(base), temp;
-	Index digitNum = len;
-	while (digitNum > 0) {
-		digitNum--;
-		temp.multiply(ans, buBase);
-		ans.add(temp, BigUnsigned(blk[digitNum]));
+	if (len == 0)
+		return BigUnsigned();
+
+	// Gather the digits into chunks that each fill most of a block.
+	Chunk chunk(base);
+	Index m = ceilingDiv(len, chunk.digits);
+	BlockMemory::ScopedArray<Blk> chunks(m);
+	Blk *c = chunks.get();
+	for (Index j = 0; j < m; j++) {
+		Index first = j * chunk.digits;
+		Index last = (first + chunk.digits < len) ? first + chunk.digits : len;
+		Blk value = 0;
+		for (Index digitNum = last; digitNum > first; digitNum--)
+			value = value * base + blk[digitNum - 1];
+		c[j] = value;
 	}
-	return ans;
+	return readChunks(c, m, chunk);
 }
 
 BigUnsignedInABase::BigUnsignedInABase(const std::string &s, Base base) {
@@ -63,13 +63,26 @@ public:
 		base = x.base;
 	}
 
+	// Move constructor and assignment: see BigUnsigned.
+	BigUnsignedInABase(BigUnsignedInABase &&x) noexcept
+		: NumberlikeArray<Digit>(std::move(x)), base(x.base) {}
+	void operator =(BigUnsignedInABase &&x) noexcept {
+		NumberlikeArray<Digit>::operator =(std::move(x));
+		base = x.base;
+	}
+
 	// Constructor that copies from a given array of digits.
 	BigUnsignedInABase(const Digit *d, Index l, Base base);
 
 	// Destructor.  NumberlikeArray does the delete for us.
 	~BigUnsignedInABase() {}
 
-	// LINKS TO BIGUNSIGNED
+	/* LINKS TO BIGUNSIGNED
+	 *
+	 * Both directions work on chunks of as many digits as fit in a block
+	 * (19 decimal digits for 64-bit blocks), one block division or
+	 * multiplication per chunk, and split large numbers in half by powers
+	 * of the base that are cached between conversions. */
 	BigUnsignedInABase(const BigUnsigned &x, Base base);
 	operator BigUnsigned() const;
 
@@ -0,0 +1,431 @@
+#ifndef BIGUNSIGNEDKERNELS_H
+#define BIGUNSIGNEDKERNELS_H
+
+#include <climits>
+#include <functional>
+
+/* Marks the block arithmetic that FixedBigUnsigned can use in constant
+ * expressions.  That takes loops and stores into std::array elements inside
+ * constexpr functions, i.e. C++17; before that it is ordinary inline code. */
+#if __cplusplus >= 201703L
+	#define BIGUNSIGNED_CONSTEXPR constexpr
+#else
+	#define BIGUNSIGNED_CONSTEXPR inline
+#endif
+
+/* Add-with-carry is part of every x86-64 processor, so its intrinsics need no
+ * runtime check. */
+#if defined(__x86_64__) && defined(__GNUC__) && ULONG_MAX == 0xffffffffffffffffUL
+	#include <x86intrin.h>
+	#define BIGUNSIGNED_HAVE_ADDCARRY
+#endif
+
+/* Low-level routines on raw little-endian arrays of blocks (limbs), shared by
+ * the BigUnsigned arithmetic.  None of them allocate or look at lengths
+ * beyond the ones they are given; callers size and zap the results.
+ *
+ * The primitive is the full block product: two N-bit blocks multiply into a
+ * 2N-bit result.  It uses a double-width integer type where the compiler has
+ * one (unsigned __int128 for 64-bit blocks) and otherwise splits each block
+ * into halves. */
+namespace BigUnsignedKernels {
+
+	typedef unsigned long Blk;
+	typedef unsigned int Index;
+
+#if ULONG_MAX == 0xffffffffUL
+	typedef unsigned long long DoubleBlk;
+	#define BIGUNSIGNED_HAVE_DOUBLE_BLK
+#elif defined(__SIZEOF_INT128__)
+	typedef unsigned __int128 DoubleBlk;
+	#define BIGUNSIGNED_HAVE_DOUBLE_BLK
+	// The transform multiplication works modulo primes just below 2^62.
+	#if ULONG_MAX == 0xffffffffffffffffUL
+		#define BIGUNSIGNED_HAVE_NTT
+	#endif
+#endif
+
+	const unsigned int N = 8 * sizeof(Blk);
+
+	// Returns the low block of a * b and stores the high block in hi.
+	BIGUNSIGNED_CONSTEXPR Blk mulWide(Blk a, Blk b, Blk &hi) {
+#ifdef BIGUNSIGNED_HAVE_DOUBLE_BLK
+		DoubleBlk p = DoubleBlk(a) * b;
+		hi = Blk(p >> N);
+		return Blk(p);
+#else
+		const unsigned int H = N / 2;
+		const Blk lowMask = (Blk(1) << H) - 1;
+		Blk a0 = a & lowMask, a1 = a >> H, b0 = b & lowMask, b1 = b >> H;
+		Blk p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+		// Middle column; cannot overflow since each term is < 2^H.
+		Blk mid = (p00 >> H) + (p01 & lowMask) + (p10 & lowMask);
+		hi = p11 + (p01 >> H) + (p10 >> H) + (mid >> H);
+		return (mid << H) | (p00 & lowMask);
+#endif
+	}
+
+	/* r = a + b over n blocks; returns the carry out.  r may alias a or b.
+	 * The portable loop, which recovers each carry by comparison. */
+	inline Blk addNGeneric(Blk *r, const Blk *a, const Blk *b, Index n) {
+		Blk carry = 0;
+		for (Index i = 0; i < n; i++) {
+			Blk s = a[i] + carry;
+			carry = (s < carry);
+			Blk t = s + b[i];
+			carry += (t < s);
+			r[i] = t;
+		}
+		return carry;
+	}
+
+	// r = a - b over n blocks; returns the borrow out.  As addNGeneric.
+	inline Blk subNGeneric(Blk *r, const Blk *a, const Blk *b, Index n) {
+		Blk borrow = 0;
+		for (Index i = 0; i < n; i++) {
+			Blk ai = a[i], bi = b[i];
+			Blk t = ai - bi;
+			Blk borrowOut = (ai < bi);
+			borrowOut += (t < borrow);
+			r[i] = t - borrow;
+			borrow = borrowOut;
+		}
+		return borrow;
+	}
+
+#ifdef BIGUNSIGNED_HAVE_ADDCARRY
+	/* The intrinsics write unsigned long long; this lets them write a block
+	 * in place.  (Going through a local instead leaves it in memory when
+	 * the chain is inlined more than once.) */
+	typedef unsigned long long __attribute__((may_alias)) CarryBlk;
+
+	// One block of an add-with-carry chain: *r = a + b + c; returns the carry.
+	inline unsigned char addCarry(unsigned char c, Blk *r, Blk a, Blk b) {
+		return _addcarry_u64(c, a, b, reinterpret_cast<CarryBlk *>(r));
+	}
+
+	// *r = a - b - c; returns the borrow.
+	inline unsigned char subBorrow(unsigned char c, Blk *r, Blk a, Blk b) {
+		return _subborrow_u64(c, a, b, reinterpret_cast<CarryBlk *>(r));
+	}
+#endif
+
+	/* r = a + b over n blocks; returns the carry out.  r may alias a or b.
+	 * Where the compiler exposes the processor's add-with-carry
+	 * instruction, the carry stays in the flag from one block to the next;
+	 * four blocks per iteration keep the loop counter from clobbering it
+	 * more often than that. */
+	inline Blk addN(Blk *r, const Blk *a, const Blk *b, Index n) {
+#ifdef BIGUNSIGNED_HAVE_ADDCARRY
+		unsigned char carry = 0;
+		for (Index k = n / 4; k > 0; k--) {
+			carry = addCarry(carry, r, a[0], b[0]);
+			carry = addCarry(carry, r + 1, a[1], b[1]);
+			carry = addCarry(carry, r + 2, a[2], b[2]);
+			carry = addCarry(carry, r + 3, a[3], b[3]);
+			r += 4;
+			a += 4;
+			b += 4;
+		}
+		for (Index k = n % 4; k > 0; k--)
+			carry = addCarry(carry, r++, *a++, *b++);
+		return carry;
+#else
+		return addNGeneric(r, a, b, n);
+#endif
+	}
+
+	// r = a - b over n blocks; returns the borrow out.  As addN.
+	inline Blk subN(Blk *r, const Blk *a, const Blk *b, Index n) {
+#ifdef BIGUNSIGNED_HAVE_ADDCARRY
+		unsigned char borrow = 0;
+		for (Index k = n / 4; k > 0; k--) {
+			borrow = subBorrow(borrow, r, a[0], b[0]);
+			borrow = subBorrow(borrow, r + 1, a[1], b[1]);
+			borrow = subBorrow(borrow, r + 2, a[2], b[2]);
+			borrow = subBorrow(borrow, r + 3, a[3], b[3]);
+			r += 4;
+			a += 4;
+			b += 4;
+		}
+		for (Index k = n % 4; k > 0; k--)
+			borrow = subBorrow(borrow, r++, *a++, *b++);
+		return borrow;
+#else
+		return subNGeneric(r, a, b, n);
+#endif
+	}
+
+	// r = a + w over n blocks; returns the carry out.  r may alias a.
+	inline Blk addWord(Blk *r, const Blk *a, Index n, Blk w) {
+		for (Index i = 0; i < n; i++) {
+			Blk t = a[i] + w;
+			w = (t < w);
+			r[i] = t;
+		}
+		return w;
+	}
+
+	// r = a - w over n blocks; returns the borrow out.  r may alias a.
+	inline Blk subWord(Blk *r, const Blk *a, Index n, Blk w) {
+		for (Index i = 0; i < n; i++) {
+			Blk ai = a[i];
+			r[i] = ai - w;
+			w = (ai < w);
+		}
+		return w;
+	}
+
+	/* x = B^n - x over n blocks, where B is 2^N: the two's complement, which
+	 * turns a difference that borrowed out of the top into its magnitude. */
+	inline void negateN(Blk *x, Index n) {
+		for (Index i = 0; i < n; i++)
+			x[i] = ~x[i];
+		addWord(x, x, n, 1);
+	}
+
+	// r = a * b over n blocks; returns the high block.  r may alias a.
+	inline Blk mulWord(Blk *r, const Blk *a, Index n, Blk b) {
+		Blk carry = 0;
+		for (Index i = 0; i < n; i++) {
+			Blk hi;
+			Blk lo = mulWide(a[i], b, hi);
+			lo += carry;
+			hi += (lo < carry);
+			r[i] = lo;
+			carry = hi;
+		}
+		return carry;
+	}
+
+	// r += a * b over n blocks; returns the block carried out of r[n - 1].
+	inline Blk addMulWord(Blk *r, const Blk *a, Index n, Blk b) {
+		Blk carry = 0;
+		for (Index i = 0; i < n; i++) {
+			Blk hi;
+			Blk lo = mulWide(a[i], b, hi);
+			lo += carry;
+			hi += (lo < carry);
+			Blk t = r[i] + lo;
+			hi += (t < lo);
+			r[i] = t;
+			carry = hi;
+		}
+		return carry;
+	}
+
+	// r -= a * b over n blocks; returns the block borrowed out of r[n - 1].
+	inline Blk subMulWord(Blk *r, const Blk *a, Index n, Blk b) {
+		Blk borrow = 0;
+		for (Index i = 0; i < n; i++) {
+			Blk hi;
+			Blk lo = mulWide(a[i], b, hi);
+			lo += borrow;
+			hi += (lo < borrow);
+			Blk t = r[i];
+			r[i] = t - lo;
+			borrow = hi + (t < lo);
+		}
+		return borrow;
+	}
+
+	// Number of leading zero bits of a nonzero block.
+	inline unsigned int countLeadingZeros(Blk x) {
+#ifdef __GNUC__
+		return __builtin_clzl(x);
+#else
+		unsigned int count = 0;
+		for (Blk top = Blk(1) << (N - 1); (x & top) == 0; x <<= 1)
+			count++;
+		return count;
+#endif
+	}
+
+	// Number of trailing zero bits of a nonzero block.
+	inline unsigned int countTrailingZeros(Blk x) {
+#ifdef __GNUC__
+		return __builtin_ctzl(x);
+#else
+		unsigned int count = 0;
+		for (; (x & 1) == 0; x >>= 1)
+			count++;
+		return count;
+#endif
+	}
+
+	/* r = a << s over n blocks, 0 <= s < N; returns the bits shifted out of
+	 * the top.  r may alias a or start above it in the same array. */
+	Blk shiftLeftBits(Blk *r, const Blk *a, Index n, unsigned int s);
+
+	/* r = a >> s over n blocks, 0 <= s < N.  r may alias a or start below
+	 * it in the same array. */
+	void shiftRightBits(Blk *r, const Blk *a, Index n, unsigned int s);
+
+	/* Whether the two shifts above use their AVX2 versions, which shift
+	 * four blocks per instruction.  Set at startup when the processor has
+	 * AVX2; clearing it selects the portable loops (see
+	 * bench/kernel_bench.cpp). */
+	extern bool vectorShifts;
+
+	/* Divides the two-block number hi:lo by d, which must exceed hi (so the
+	 * quotient fits in a block); returns the quotient and stores the
+	 * remainder in r. */
+	inline Blk divWide(Blk hi, Blk lo, Blk d, Blk &r) {
+#ifdef BIGUNSIGNED_HAVE_DOUBLE_BLK
+		DoubleBlk u = (DoubleBlk(hi) << N) | lo;
+		r = Blk(u % d);
+		return Blk(u / d);
+#else
+		/* Knuth D on half blocks (as in Hacker's Delight, divlu): normalize
+		 * d, then produce the quotient a half block at a time. */
+		const unsigned int H = N / 2;
+		const Blk b = Blk(1) << H, lowMask = b - 1;
+		unsigned int s = countLeadingZeros(d);
+		d <<= s;
+		Blk un32 = (s == 0) ? hi : ((hi << s) | (lo >> (N - s)));
+		Blk un10 = lo << s;
+		Blk d1 = d >> H, d0 = d & lowMask;
+		Blk un1 = un10 >> H, un0 = un10 & lowMask;
+		Blk q1 = un32 / d1, rhat = un32 - q1 * d1;
+		while (q1 >= b || q1 * d0 > ((rhat << H) | un1)) {
+			q1--;
+			rhat += d1;
+			if (rhat >= b)
+				break;
+		}
+		Blk un21 = (un32 << H) + un1 - q1 * d;
+		Blk q0 = un21 / d1;
+		rhat = un21 - q0 * d1;
+		while (q0 >= b || q0 * d0 > ((rhat << H) | un0)) {
+			q0--;
+			rhat += d1;
+			if (rhat >= b)
+				break;
+		}
+		r = ((un21 << H) + un0 - q0 * d) >> s;
+		return (q1 << H) | q0;
+#endif
+	}
+
+	/* floor((B^2 - 1) / d) - B for a normalized d (top bit set), where B is
+	 * 2^N: the reciprocal used by divNormalized. */
+	inline Blk reciprocal(Blk d) {
+		Blk r;
+		return divWide(~d, ~Blk(0), d, r);
+	}
+
+	/* Divides u1:u0 by a normalized d > u1 with a multiplication by its
+	 * precomputed reciprocal v instead of a hardware division (Moller and
+	 * Granlund, ``Improved division by invariant integers'', 2011). */
+	inline Blk divNormalized(Blk u1, Blk u0, Blk d, Blk v, Blk &r) {
+		Blk q1;
+		Blk q0 = mulWide(v, u1, q1);
+		Blk t = q0 + u0;
+		q1 += u1 + 1 + (t < q0);
+		q0 = t;
+		Blk rem = u0 - q1 * d;
+		if (rem > q0) {
+			q1--;
+			rem += d;
+		}
+		if (rem >= d) {
+			q1++;
+			rem -= d;
+		}
+		r = rem;
+		return q1;
+	}
+
+	// Compares two n-block arrays like BigUnsigned::compareTo.
+	inline int compareN(const Blk *a, const Blk *b, Index n) {
+		while (n > 0) {
+			n--;
+			if (a[n] != b[n])
+				return (a[n] > b[n]) ? 1 : -1;
+		}
+		return 0;
+	}
+
+	/* r[0 .. an + bn) = a * b by the schoolbook method, one row of block
+	 * products per block of b.  r must not overlap a or b. */
+	inline void mulSchoolbook(Blk *r, const Blk *a, Index an,
+			const Blk *b, Index bn) {
+		r[an] = mulWord(r, a, an, b[0]);
+		for (Index j = 1; j < bn; j++)
+			r[an + j] = addMulWord(r + j, a, an, b[j]);
+	}
+
+	/* Operands with at least this many blocks (both of them) are multiplied
+	 * by Karatsuba's method; smaller ones by the schoolbook method.  Must be
+	 * at least 4.  See bench/multiply_bench.cpp for measuring the crossover
+	 * on a given machine. */
+	extern Index karatsubaThreshold;
+
+	/* r[0 .. an + bn) = a * b, choosing the method by size.  r must not
+	 * overlap a or b.  Temporary space is allocated internally. */
+	void multiply(Blk *r, const Blk *a, Index an, const Blk *b, Index bn);
+
+	/* Operands with at least this many blocks are squared by Karatsuba's
+	 * method; smaller ones by the schoolbook method, which forms each
+	 * cross product a_i a_j once and doubles their sum.  Must be at least
+	 * 4.  See bench/multiply_bench.cpp. */
+	extern Index karatsubaSquareThreshold;
+
+	/* Operands with at least this many blocks (both of them, and below
+	 * nttThreshold) are multiplied by Toom-3, splitting them into thirds;
+	 * smaller ones by Karatsuba's method.  toom3SquareThreshold is the same
+	 * for squares.  Both must be at least 5.  See
+	 * bench/calibrate_bench.cpp. */
+	extern Index toom3Threshold;
+	extern Index toom3SquareThreshold;
+
+	/* r[0 .. 2n) = a * a.  Below the transforms it computes about half the
+	 * block products of multiply (schoolbook) or needs two half-size
+	 * squares and the square of a difference (Karatsuba), or five
+	 * third-size squares (Toom-3).  With transforms it takes one forward
+	 * transform instead of two, and it switches to them from two thirds of
+	 * nttThreshold.  r must not overlap a. */
+	void square(Blk *r, const Blk *a, Index n);
+
+#ifdef BIGUNSIGNED_HAVE_NTT
+	/* Operands with at least this many blocks (the shorter of them) are
+	 * multiplied by number-theoretic transforms modulo three primes, in
+	 * O(n log n) block operations.  See bench/multiply_bench.cpp. */
+	extern Index nttThreshold;
+
+	/* r[0 .. an + bn) = a * b, and r[0 .. 2n) = a * a, by transforms
+	 * (BigUnsignedNTT.cpp) whatever the size.  r must not overlap the
+	 * operands. */
+	void multiplyNTT(Blk *r, const Blk *a, Index an, const Blk *b, Index bn);
+	void squareNTT(Blk *r, const Blk *a, Index n);
+#endif
+
+	/* At most this many threads work on one multiplication or square.  Set
+	 * at startup to the number of hardware threads; 1 keeps every product
+	 * on the calling thread.  See bench/parallel_bench.cpp. */
+	extern unsigned int multiplyThreads;
+
+	/* Products whose shorter operand has at least this many blocks are split
+	 * across those threads: the three half-size products of the top
+	 * Karatsuba levels, or the three prime convolutions of the transforms
+	 * and the passes inside them, run as separate tasks. */
+	extern Index parallelThreshold;
+
+	/* Runs task(0), ..., task(count - 1) on up to `threads' threads, one of
+	 * them the calling thread, and returns once all are done.  An exception
+	 * from a task is rethrown here (BigUnsignedParallel.cpp). */
+	void runTasks(Index count, unsigned int threads,
+			const std::function<void(Index)> &task);
+
+	/* q = a / d over n blocks for a single nonzero block d; returns the
+	 * remainder.  q may alias a. */
+	Blk divWord(Blk *q, const Blk *a, Index n, Blk d);
+
+	/* Knuth's Algorithm D.  u has un blocks and v has n >= 2 blocks with the
+	 * top bit of v[n - 1] set and u[un - 1] < v[n - 1].  Stores the
+	 * un - n blocks of u / v in q and leaves the remainder in u[0 .. n).
+	 * q must not overlap u or v. */
+	void divideNormalized(Blk *q, Blk *u, Index un, const Blk *v, Index n);
+}
+
+#endif
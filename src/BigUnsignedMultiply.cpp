@@ -0,0 +1,459 @@
+#include "BigUnsignedKernels.hh"
+#include "BigUnsignedThresholds.hh"
+#include "BlockArena.hh"
+
+/* Block-array multiplication for BigUnsigned::multiply.
+ *
+ * Karatsuba's method splits each n-block operand at h = n / 2 into
+ * a = a1 B^h + a0 and b = b1 B^h + b0 and forms
+ *     a b = z2 B^2h + (z1 - z2 - z0) B^h + z0,
+ * with z0 = a0 b0, z2 = a1 b1 and z1 = (a0 + a1)(b0 + b1): three half-size
+ * products instead of four.  Below karatsubaThreshold the schoolbook rows
+ * win.  Unbalanced operands are multiplied a chunk of the longer one at a
+ * time.  From nttThreshold blocks up, BigUnsignedNTT.cpp takes over.
+ *
+ * All temporaries come from one scratch array allocated up front (through
+ * BlockMemory, so an open arena supplies it); each
+ * Karatsuba level takes 4(m + 1) blocks (m = n - h) and passes the rest
+ * down to its recursive calls, which run one after another.
+ *
+ * Squares use the symmetry of a a.  The schoolbook square forms each cross
+ * product a_i a_j (i < j) once, doubles their sum and adds the n squares
+ * a_i^2 on the diagonal: n (n + 1) / 2 block products instead of n^2.
+ * Karatsuba's square takes z1 from the difference of the halves,
+ *     a a = z2 B^2h + (z2 + z0 - (a1 - a0)^2) B^h + z0,
+ * so all three half-size products are squares again and the difference
+ * needs no extra block, 3m + 1 blocks of scratch per level.
+ *
+ * Between Karatsuba and the transforms, from toom3Threshold blocks up, Toom-3
+ * splits each operand into thirds of k = ceil(n / 3) blocks,
+ * a = a2 x^2 + a1 x + a0 with x = B^k, evaluates both at 0, 1, -1, -2 and
+ * infinity, and multiplies the five values: five products of a third of the
+ * size instead of Karatsuba's three of a half.  The five coefficients of the
+ * product come back by Bodrato's interpolation sequence,
+ *     r3 = (v(-2) - v(1)) / 3,        r1 = (v(1) - v(-1)) / 2,
+ *     r2 = v(-1) - v(0),              r3 = (r2 - r3) / 2 + 2 v(inf),
+ *     r2 = r2 + r1 - v(inf),          r1 = r1 - r3,
+ * whose intermediate values may be negative.  They are kept in two's
+ * complement in 2(k + 1) blocks, the length of the products of the k + 1
+ * block values, where the exact division by 3 is a multiplication by the
+ * inverse of 3 modulo B and the halving an arithmetic shift.  v(0) and
+ * v(inf) go straight into their places in r.  Squares take the same route
+ * with squares for the five products.
+ *
+ * From parallelThreshold blocks up, with multiplyThreads above 1, the
+ * products of a Karatsuba or Toom-3 level are independent tasks
+ * (karatsubaTasks, toom3).  The transforms split their own work likewise;
+ * see BigUnsignedNTT.cpp.
+ *
+ * The thresholds start out at the values in the generated
+ * BigUnsignedThresholds.hh; see src/CMakeLists.txt. */
+
+namespace BigUnsignedKernels {
+
+	Index karatsubaThreshold = BIGUNSIGNED_KARATSUBA_THRESHOLD;
+	Index karatsubaSquareThreshold = BIGUNSIGNED_KARATSUBA_SQUARE_THRESHOLD;
+	Index toom3Threshold = BIGUNSIGNED_TOOM3_THRESHOLD;
+	Index toom3SquareThreshold = BIGUNSIGNED_TOOM3_SQUARE_THRESHOLD;
+
+	namespace {
+
+		// Blocks of scratch that karatsuba needs for n-block operands.
+		Index karatsubaScratch(Index n) {
+			Index total = 0;
+			while (n >= karatsubaThreshold) {
+				Index m = n - n / 2;
+				total += 4 * (m + 1);
+				n = m + 1;
+			}
+			return total;
+		}
+
+		/* r = a + b where a has an blocks and b has bn <= an blocks; writes
+		 * an blocks and returns the carry. */
+		Blk addUnequal(Blk *r, const Blk *a, Index an, const Blk *b, Index bn) {
+			Blk carry = addN(r, a, b, bn);
+			return addWord(r + bn, a + bn, an - bn, carry);
+		}
+
+		/* The steps of a Karatsuba level around its three products, for n
+		 * blocks split at h = n / 2 with m = n - h. */
+
+		// sa, sb = the sums of the halves of a and b, m + 1 blocks each.
+		void halfSums(Blk *sa, Blk *sb, const Blk *a, const Blk *b, Index h,
+				Index m) {
+			sa[m] = addUnequal(sa, a + h, m, a, h);
+			sb[m] = addUnequal(sb, b + h, m, b, h);
+		}
+
+		/* Adds the zn-block term z1 (the middle one, or a Toom-3
+		 * coefficient) into the 2n-block r at B^h.  Its blocks past the end
+		 * of r are zero because the whole product fits in 2n blocks. */
+		void addMiddle(Blk *r, Index n, Index h, const Blk *z1, Index zn) {
+			Index span = 2 * n - h;
+			if (zn > span)
+				zn = span;
+			Blk carry = addN(r + h, r + h, z1, zn);
+			addWord(r + h + zn, r + h + zn, span - zn, carry);
+		}
+
+		/* With z0 and z2 in place in r and z1 = (a0 + a1)(b0 + b1) in
+		 * 2(m + 1) blocks, subtracts z0 + z2 from z1 (the difference is
+		 * nonnegative) and adds it in. */
+		void combine(Blk *r, Index n, Index h, Blk *z1) {
+			Index m = n - h, zn = 2 * (m + 1);
+			Blk borrow = subN(z1, z1, r, 2 * h);
+			subWord(z1 + 2 * h, z1 + 2 * h, zn - 2 * h, borrow);
+			borrow = subN(z1, z1, r + 2 * h, 2 * m);
+			subWord(z1 + 2 * m, z1 + 2 * m, zn - 2 * m, borrow);
+			addMiddle(r, n, h, z1, zn);
+		}
+
+		// d = |a1 - a0|, m blocks.
+		void halfDifference(Blk *d, const Blk *a, Index h, Index m) {
+			Blk borrow = subN(d, a + h, a, h);
+			if (subWord(d + h, a + h + h, m - h, borrow) != 0)
+				negateN(d, m);
+		}
+
+		/* With z0 and z2 in place in r and z1 = d^2 in 2m of its 2m + 1
+		 * blocks, makes z1 = z0 + z2 - d^2, which is 2 a0 a1 >= 0, modulo
+		 * B^(2m + 1) from the two's complement of d^2, and adds it in. */
+		void combineSquare(Blk *r, Index n, Index h, Blk *z1) {
+			Index m = n - h, zn = 2 * m + 1;
+			z1[2 * m] = 0;
+			negateN(z1, zn);
+			Blk carry = addN(z1, z1, r, 2 * h);
+			addWord(z1 + 2 * h, z1 + 2 * h, zn - 2 * h, carry);
+			carry = addN(z1, z1, r + 2 * h, 2 * m);
+			z1[2 * m] += carry;
+			addMiddle(r, n, h, z1, zn);
+		}
+
+		// r[0 .. 2n) = a * b for n-block operands.
+		void karatsuba(Blk *r, const Blk *a, const Blk *b, Index n,
+				Blk *scratch) {
+			if (n < karatsubaThreshold) {
+				mulSchoolbook(r, a, n, b, n);
+				return;
+			}
+			Index h = n / 2, m = n - h;
+			Blk *sa = scratch;
+			Blk *sb = sa + (m + 1);
+			Blk *z1 = sb + (m + 1);
+			Blk *next = z1 + 2 * (m + 1);
+
+			halfSums(sa, sb, a, b, h, m);
+			// z0 and z2 go straight into their places in r.
+			karatsuba(r, a, b, h, next);
+			karatsuba(r + 2 * h, a + h, b + h, m, next);
+			karatsuba(z1, sa, sb, m + 1, next);
+			combine(r, n, h, z1);
+		}
+
+		// r[0 .. 2n) = a * a by the schoolbook method; see above.
+		void squareSchoolbook(Blk *r, const Blk *a, Index n) {
+			// The cross products, row i holding a_i a_j for j > i.
+			r[0] = 0;
+			r[2 * n - 1] = 0;
+			if (n > 1) {
+				r[n] = mulWord(r + 1, a + 1, n - 1, a[0]);
+				for (Index i = 1; i + 1 < n; i++)
+					r[n + i] = addMulWord(r + 2 * i + 1, a + i + 1, n - i - 1,
+							a[i]);
+			}
+			// Twice their sum is below a a, so nothing carries out.
+			addN(r, r, r, 2 * n);
+			// The diagonal, two blocks per square.
+			Blk carry = 0;
+			for (Index i = 0; i < n; i++) {
+				Blk hi;
+				Blk lo = mulWide(a[i], a[i], hi);
+				Blk t = r[2 * i] + lo;
+				hi += (t < lo);
+				r[2 * i] = t + carry;
+				hi += (r[2 * i] < t);
+				t = r[2 * i + 1] + hi;
+				carry = (t < hi);
+				r[2 * i + 1] = t;
+			}
+		}
+
+		// Blocks of scratch that karatsubaSquare needs for n blocks.
+		Index karatsubaSquareScratch(Index n) {
+			Index total = 0;
+			while (n >= karatsubaSquareThreshold) {
+				Index m = n - n / 2;
+				total += 3 * m + 1;
+				n = m;
+			}
+			return total;
+		}
+
+		// r[0 .. 2n) = a * a; see above.
+		void karatsubaSquare(Blk *r, const Blk *a, Index n, Blk *scratch) {
+			if (n < karatsubaSquareThreshold) {
+				squareSchoolbook(r, a, n);
+				return;
+			}
+			Index h = n / 2, m = n - h;
+			Blk *d = scratch;
+			Blk *z1 = d + m;
+			Blk *next = z1 + (2 * m + 1);
+
+			halfDifference(d, a, h, m);
+			karatsubaSquare(r, a, h, next);
+			karatsubaSquare(r + 2 * h, a + h, m, next);
+			karatsubaSquare(z1, d, m, next);
+			combineSquare(r, n, h, z1);
+		}
+
+		/* karatsuba, or karatsubaSquare when b is NULL, with the three
+		 * products of each level from parallelThreshold blocks up run as
+		 * tasks on up to `threads' threads.  Each task gets a third of the
+		 * threads for its own levels and allocates its own scratch. */
+		void karatsubaTasks(Blk *r, const Blk *a, const Blk *b, Index n,
+				unsigned int threads) {
+			Index threshold = (b == NULL) ? karatsubaSquareThreshold
+				: karatsubaThreshold;
+			if (threads < 2 || n < parallelThreshold || n < threshold) {
+				BlockMemory::ScopedArray<Blk> scratch((b == NULL)
+						? karatsubaSquareScratch(n) : karatsubaScratch(n) + 1);
+				if (b == NULL)
+					karatsubaSquare(r, a, n, scratch.get());
+				else
+					karatsuba(r, a, b, n, scratch.get());
+				return;
+			}
+			Index h = n / 2, m = n - h;
+			BlockMemory::ScopedArray<Blk> spaceArray(4 * (m + 1));
+			Blk *space = spaceArray.get();
+			Blk *sa = space;
+			Blk *sb = sa + (m + 1);
+			Blk *z1 = sb + (m + 1);
+			if (b == NULL)
+				halfDifference(sa, a, h, m);
+			else
+				halfSums(sa, sb, a, b, h, m);
+
+			unsigned int each = (threads >= 3) ? threads / 3 : 1;
+			runTasks(3, threads, [=](Index i) {
+				if (i == 0)
+					karatsubaTasks(r, a, b, h, each);
+				else if (i == 1)
+					karatsubaTasks(r + 2 * h, a + h, (b == NULL) ? NULL : b + h,
+							m, each);
+				else if (b == NULL)
+					karatsubaTasks(z1, sa, NULL, m, each);
+				else
+					karatsubaTasks(z1, sa, sb, m + 1, each);
+			});
+
+			if (b == NULL)
+				combineSquare(r, n, h, z1);
+			else
+				combine(r, n, h, z1);
+		}
+
+		void toom3(Blk *r, const Blk *a, const Blk *b, Index n,
+				unsigned int threads);
+
+		/* r[0 .. 2n) = a * b, or a * a when b is NULL, for n-block operands
+		 * by Toom-3 or Karatsuba's method, whichever the size calls for. */
+		void balanced(Blk *r, const Blk *a, const Blk *b, Index n,
+				unsigned int threads) {
+			Index threshold = (b == NULL) ? toom3SquareThreshold
+				: toom3Threshold;
+			if (n >= threshold)
+				toom3(r, a, b, n, threads);
+			else
+				karatsubaTasks(r, a, b, n, threads);
+		}
+
+		/* x = x / 3 over n blocks for x divisible by 3, in two's
+		 * complement: each quotient block is the remaining dividend block
+		 * times the inverse of 3 modulo B, and three times it overshoots
+		 * that block by a borrow of at most 2 from the next. */
+		void divideExactly3(Blk *x, Index n) {
+			const Blk inverse = ~Blk(0) / 3 * 2 + 1;
+			Blk borrow = 0;
+			for (Index i = 0; i < n; i++) {
+				Blk t = x[i] - borrow, hi;
+				Blk under = (x[i] < borrow);
+				Blk q = t * inverse;
+				mulWide(q, 3, hi);
+				x[i] = q;
+				borrow = hi + under;
+			}
+		}
+
+		// x = x / 2 over n blocks for even x, in two's complement.
+		void halveSigned(Blk *x, Index n) {
+			Blk top = x[n - 1] & (Blk(1) << (N - 1));
+			shiftRightBits(x, x, n, 1);
+			x[n - 1] |= top;
+		}
+
+		/* The values at 1, -1 and -2 of the n-block a = a2 x^2 + a1 x + a0
+		 * split at k blocks: stores their magnitudes in p1, pm1 and pm2,
+		 * k + 1 blocks each, and whether the last two are negative.  They
+		 * are worked out modulo B^(k + 1), where all of them are below half
+		 * the modulus, and the negative ones negated at the end. */
+		void toom3Evaluate(Blk *p1, Blk *pm1, Blk *pm2, bool &negative1,
+				bool &negative2, const Blk *a, Index n, Index k) {
+			const Blk *a0 = a, *a1 = a + k, *a2 = a + 2 * k;
+			Index s = n - 2 * k;
+			// pm1 = a0 + a2, then p1 = pm1 + a1 and pm1 = pm1 - a1.
+			pm1[k] = addUnequal(pm1, a0, k, a2, s);
+			Blk carry = addN(p1, pm1, a1, k);
+			p1[k] = pm1[k] + carry;
+			Blk borrow = subN(pm1, pm1, a1, k);
+			pm1[k] -= borrow;
+			// pm2 = 2 (pm1 + a2) - a0
+			carry = addN(pm2, pm1, a2, s);
+			addWord(pm2 + s, pm1 + s, k + 1 - s, carry);
+			shiftLeftBits(pm2, pm2, k + 1, 1);
+			borrow = subN(pm2, pm2, a0, k);
+			pm2[k] -= borrow;
+
+			negative1 = (pm1[k] >> (N - 1)) != 0;
+			if (negative1)
+				negateN(pm1, k + 1);
+			negative2 = (pm2[k] >> (N - 1)) != 0;
+			if (negative2)
+				negateN(pm2, k + 1);
+		}
+
+		/* r[0 .. 2n) = a * b, or a * a when b is NULL, by Toom-3; see
+		 * above.  From parallelThreshold blocks up the five products run
+		 * as tasks, each on a fifth of the threads. */
+		void toom3(Blk *r, const Blk *a, const Blk *b, Index n,
+				unsigned int threads) {
+			Index k = (n + 2) / 3, s = n - 2 * k, w = 2 * (k + 1);
+			BlockMemory::ScopedArray<Blk> spaceArray(6 * (k + 1) + 3 * w);
+			Blk *space = spaceArray.get();
+			Blk *pa = space;
+			Blk *pb = pa + 3 * (k + 1);
+			Blk *v1 = pb + 3 * (k + 1);
+			Blk *vm1 = v1 + w;
+			Blk *vm2 = vm1 + w;
+
+			bool am1, am2, bm1, bm2;
+			toom3Evaluate(pa, pa + (k + 1), pa + 2 * (k + 1), am1, am2,
+					a, n, k);
+			if (b != NULL)
+				toom3Evaluate(pb, pb + (k + 1), pb + 2 * (k + 1), bm1, bm2,
+						b, n, k);
+			else {
+				// Squares are nonnegative.
+				bm1 = am1;
+				bm2 = am2;
+			}
+
+			bool split = threads >= 2 && n >= parallelThreshold;
+			unsigned int each = !split ? threads
+				: (threads >= 5) ? threads / 5 : 1;
+			runTasks(5, split ? threads : 1, [=](Index i) {
+				const Blk *x = (i == 0) ? a : (i == 1) ? a + 2 * k
+					: pa + (i - 2) * (k + 1);
+				const Blk *y = NULL;
+				if (b != NULL)
+					y = (i == 0) ? b : (i == 1) ? b + 2 * k
+						: pb + (i - 2) * (k + 1);
+				// v(0) and v(inf) go into r, the others into their arrays.
+				if (i == 0)
+					balanced(r, x, y, k, each);
+				else if (i == 1)
+					balanced(r + 4 * k, x, y, s, each);
+				else
+					balanced(v1 + (i - 2) * w, x, y, k + 1, each);
+			});
+			if (am1 != bm1)
+				negateN(vm1, w);
+			if (am2 != bm2)
+				negateN(vm2, w);
+
+			const Blk *v0 = r, *vinf = r + 4 * k;
+			// r3 = (v(-2) - v(1)) / 3 in vm2
+			subN(vm2, vm2, v1, w);
+			divideExactly3(vm2, w);
+			// r1 = (v(1) - v(-1)) / 2 in v1
+			subN(v1, v1, vm1, w);
+			halveSigned(v1, w);
+			// r2 = v(-1) - v(0) in vm1
+			Blk borrow = subN(vm1, vm1, v0, 2 * k);
+			subWord(vm1 + 2 * k, vm1 + 2 * k, w - 2 * k, borrow);
+			// r3 = (r2 - r3) / 2 + 2 v(inf)
+			subN(vm2, vm1, vm2, w);
+			halveSigned(vm2, w);
+			for (int twice = 0; twice < 2; twice++) {
+				Blk carry = addN(vm2, vm2, vinf, 2 * s);
+				addWord(vm2 + 2 * s, vm2 + 2 * s, w - 2 * s, carry);
+			}
+			// r2 = r2 + r1 - v(inf)
+			addN(vm1, vm1, v1, w);
+			borrow = subN(vm1, vm1, vinf, 2 * s);
+			subWord(vm1 + 2 * s, vm1 + 2 * s, w - 2 * s, borrow);
+			// r1 = r1 - r3
+			subN(v1, v1, vm2, w);
+
+			// r holds v(0) and v(inf); the other three are added in.
+			for (Index i = 2 * k; i < 4 * k; i++)
+				r[i] = 0;
+			addMiddle(r, n, k, v1, w);
+			addMiddle(r, n, 2 * k, vm1, w);
+			addMiddle(r, n, 3 * k, vm2, w);
+		}
+	}
+
+	void multiply(Blk *r, const Blk *a, Index an, const Blk *b, Index bn) {
+		if (an < bn) {
+			const Blk *t = a; a = b; b = t;
+			Index tn = an; an = bn; bn = tn;
+		}
+		if (bn < karatsubaThreshold) {
+			mulSchoolbook(r, a, an, b, bn);
+			return;
+		}
+#ifdef BIGUNSIGNED_HAVE_NTT
+		if (bn >= nttThreshold) {
+			multiplyNTT(r, a, an, b, bn);
+			return;
+		}
+#endif
+		if (an == bn) {
+			balanced(r, a, b, bn, multiplyThreads);
+			return;
+		}
+
+		/* Unbalanced: multiply b by successive bn-block chunks of a and add
+		 * each product in at its offset. */
+		Index total = an + bn;
+		for (Index i = 0; i < total; i++)
+			r[i] = 0;
+		BlockMemory::ScopedArray<Blk> productArray(2 * bn);
+		Blk *product = productArray.get();
+		for (Index offset = 0; offset < an; offset += bn) {
+			Index chunk = (an - offset < bn) ? an - offset : bn;
+			multiply(product, a + offset, chunk, b, bn);
+			Blk carry = addN(r + offset, r + offset, product, chunk + bn);
+			Index rest = offset + chunk + bn;
+			addWord(r + rest, r + rest, total - rest, carry);
+		}
+	}
+
+	void square(Blk *r, const Blk *a, Index n) {
+#ifdef BIGUNSIGNED_HAVE_NTT
+		// Two transforms instead of three pay off that much sooner.
+		if (n >= nttThreshold / 3 * 2) {
+			squareNTT(r, a, n);
+			return;
+		}
+#endif
+		if (n < karatsubaSquareThreshold) {
+			squareSchoolbook(r, a, n);
+			return;
+		}
+		balanced(r, a, NULL, n, multiplyThreads);
+	}
+}
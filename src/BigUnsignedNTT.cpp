@@ -0,0 +1,379 @@
+#include "BigUnsignedKernels.hh"
+#include "BigUnsignedThresholds.hh"
+#include "BlockArena.hh"
+
+/* Number-theoretic-transform multiplication for BigUnsigned::multiply on
+ * very long operands.
+ *
+ * The blocks of each operand are the coefficients of a polynomial in
+ * B = 2^N, so a b is the product polynomial evaluated at B.  The product's
+ * coefficients are found modulo three primes p = c 2^k + 1 below 2^62 by
+ * cyclic convolutions of a power-of-two length L >= an + bn: forward
+ * transforms, pointwise products, inverse transform.  A coefficient is a sum
+ * of fewer than L products of two blocks, so it is below L 2^128, which is
+ * below the product of the primes (about 2^183) for any length an Index can
+ * hold; Garner's form of the Chinese remainder theorem recovers it exactly,
+ * and adding the coefficients in at their offsets propagates the carries.
+ *
+ * Arithmetic modulo each prime is Montgomery multiplication with R = 2^64,
+ * which needs no division.  The roots of unity are kept in Montgomery form,
+ * so a butterfly leaves the transformed values in whatever scale they came
+ * in with; the R^-1 picked up by the pointwise product is taken out together
+ * with the 1 / L of the inverse transform.  The forward transform
+ * (decimation in frequency) leaves its output in bit-reversed order and the
+ * inverse transform (decimation in time) starts from that order, so neither
+ * needs a permutation pass.
+ *
+ * The work splits across threads (see multiplyThreads) in two ways: the
+ * three convolutions are independent, and within one, the first stages of
+ * a forward transform (or the last of an inverse one) divide into runs of
+ * butterflies while the rest is a set of independent shorter transforms.
+ * The root tables, the pointwise passes and the recombination, which
+ * starts each range with no carry and adds the carries in afterwards,
+ * divide into ranges. */
+
+#ifdef BIGUNSIGNED_HAVE_NTT
+
+namespace BigUnsignedKernels {
+
+	Index nttThreshold = BIGUNSIGNED_NTT_THRESHOLD;
+
+	namespace {
+
+		/* Runs f(begin, end) on `parts' ranges that together cover
+		 * [0, count), as tasks on that many threads. */
+		void forParts(Index count, Index parts,
+				const std::function<void(Index, Index)> &f) {
+			Index size = (count + parts - 1) / parts;
+			runTasks(parts, parts, [&](Index t) {
+				Index begin = t * size, end = begin + size;
+				if (end > count)
+					end = count;
+				if (begin < end)
+					f(begin, end);
+			});
+		}
+
+		// Arithmetic modulo one odd prime p < 2^62.
+		class Prime {
+		public:
+			Blk p;
+			// -p^-1 mod R
+			Blk inverse;
+			// R mod p (1 in Montgomery form) and R^2 mod p
+			Blk one, rSquared;
+			// A generator of the multiplicative group, in Montgomery form
+			Blk generator;
+
+			Prime(Blk p, Blk g) : p(p) {
+				// An odd p is its own inverse mod 8; Newton doubles the bits.
+				Blk x = p;
+				for (unsigned int bits = 3; bits < N; bits *= 2)
+					x *= 2 - p * x;
+				inverse = 0 - x;
+				one = Blk((DoubleBlk(1) << N) % p);
+				rSquared = Blk(DoubleBlk(one) * one % p);
+				generator = mul(g, rSquared);
+			}
+
+			/* x - p if that is not negative, else x, for x < 2^63: x - p is
+			 * negative exactly when its top bit is set, and adding p back
+			 * under that mask keeps the reductions free of unpredictable
+			 * branches.  Maps [0, 2 p) to [0, p). */
+			Blk reduce(Blk x) const {
+				x -= p;
+				return x + (p & (0 - (x >> (N - 1))));
+			}
+
+			/* a b R^-1 mod p, for any block a and b < p.  a b + m p is
+			 * below 2 p R, so one subtraction finishes the reduction. */
+			Blk mul(Blk a, Blk b) const {
+				DoubleBlk t = DoubleBlk(a) * b;
+				Blk m = Blk(t) * inverse;
+				return reduce(Blk((t + DoubleBlk(m) * p) >> N));
+			}
+			Blk add(Blk a, Blk b) const {
+				return reduce(a + b);
+			}
+			Blk sub(Blk a, Blk b) const {
+				Blk d = a - b;
+				return d + (p & (0 - (d >> (N - 1))));
+			}
+
+			// x^e for x in Montgomery form, in Montgomery form.
+			Blk power(Blk x, Blk e) const {
+				Blk acc = one;
+				for (; e != 0; e >>= 1) {
+					if (e & 1)
+						acc = mul(acc, x);
+					x = mul(x, x);
+				}
+				return acc;
+			}
+			// The Montgomery form of x^-1.
+			Blk reciprocal(Blk x) const {
+				return power(mul(x, rSquared), p - 2);
+			}
+
+			/* Stage tables for length L: roots[h + j] = w^j for j < h, where
+			 * w is a primitive 2h-th root of unity (or its inverse), for
+			 * each h = 1, 2, 4, ..., L / 2.  Only the top table takes
+			 * multiplications, in `parts' independent runs; w for h is the
+			 * square of w for 2h, so each lower table is every other entry
+			 * of the one above. */
+			void makeRoots(Blk *roots, Index L, bool inverted,
+					Index parts) const {
+				Index top = L / 2;
+				Blk w = power(generator, (p - 1) / L);
+				if (inverted)
+					w = power(w, L - 1);
+				forParts(top, parts, [=](Index begin, Index end) {
+					Blk x = power(w, begin);
+					for (Index j = begin; j < end; j++) {
+						roots[top + j] = x;
+						x = mul(x, w);
+					}
+				});
+				for (Index h = top / 2; h >= 1; h /= 2)
+					for (Index j = 0; j < h; j++)
+						roots[h + j] = roots[2 * h + 2 * j];
+			}
+
+			// Butterflies [begin, end) of a forward stage h on lo, lo + h.
+			void forwardButterflies(Blk *lo, Index h, Index begin, Index end,
+					const Blk *w) const {
+				Blk *hi = lo + h;
+				for (Index j = begin; j < end; j++) {
+					Blk u = lo[j], v = hi[j];
+					lo[j] = add(u, v);
+					hi[j] = mul(sub(u, v), w[j]);
+				}
+			}
+
+			// The same for an inverse stage.
+			void inverseButterflies(Blk *lo, Index h, Index begin, Index end,
+					const Blk *w) const {
+				Blk *hi = lo + h;
+				for (Index j = begin; j < end; j++) {
+					Blk u = lo[j], v = mul(hi[j], w[j]);
+					lo[j] = add(u, v);
+					hi[j] = sub(u, v);
+				}
+			}
+
+			/* Stage h of a length-L transform, split into `parts' runs of
+			 * equal length, each inside one group of 2h values. */
+			void stage(Blk *x, Index L, Index h, Index parts, bool inverse,
+					const Blk *roots) const {
+				Index run = L / 2 / parts;
+				runTasks(parts, parts, [=](Index t) {
+					Index k = t * run;
+					Blk *lo = x + k / h * 2 * h;
+					Index j = k % h;
+					if (inverse)
+						inverseButterflies(lo, h, j, j + run, roots + h);
+					else
+						forwardButterflies(lo, h, j, j + run, roots + h);
+				});
+			}
+
+			/* Decimation in frequency: natural order in, bit-reversed out.
+			 * The stages down to h = L / parts mix the whole array and are
+			 * split into runs; after them the array is `parts' independent
+			 * transforms of length L / parts. */
+			void forward(Blk *x, Index L, const Blk *roots,
+					Index parts) const {
+				Index size = L / parts;
+				for (Index h = L / 2; h >= size; h /= 2)
+					stage(x, L, h, parts, false, roots);
+				runTasks(parts, parts, [=](Index t) {
+					for (Index h = size / 2; h >= 1; h /= 2)
+						for (Index s = t * size; s < (t + 1) * size; s += 2 * h)
+							forwardButterflies(x + s, h, 0, h, roots + h);
+				});
+			}
+
+			// Decimation in time: bit-reversed order in, natural out.
+			void inverseTransform(Blk *x, Index L, const Blk *roots,
+					Index parts) const {
+				Index size = L / parts;
+				runTasks(parts, parts, [=](Index t) {
+					for (Index h = 1; h < size; h *= 2)
+						for (Index s = t * size; s < (t + 1) * size; s += 2 * h)
+							inverseButterflies(x + s, h, 0, h, roots + h);
+				});
+				for (Index h = size; h < L; h *= 2)
+					stage(x, L, h, parts, true, roots);
+			}
+
+			// x[0 .. L) = a mod p, padded with zeros.
+			void load(Blk *x, const Blk *a, Index n, Index L,
+					Index parts) const {
+				forParts(L, parts, [=](Index begin, Index end) {
+					for (Index i = begin; i < end; i++)
+						x[i] = (i < n) ? mul(a[i], one) : 0;
+				});
+			}
+
+			/* x = the cyclic convolution of a and b modulo p, or of a with
+			 * itself when b is NULL (one forward transform fewer).  y is
+			 * L blocks of scratch for b's transform, roots L blocks for
+			 * the tables.  Every pass is split into `parts' tasks, a power
+			 * of two no more than L / 2. */
+			void convolve(Blk *x, Blk *y, Blk *roots, Index L,
+					const Blk *a, Index an, const Blk *b, Index bn,
+					Index parts) const {
+				makeRoots(roots, L, false, parts);
+				load(x, a, an, L, parts);
+				forward(x, L, roots, parts);
+				if (b != NULL) {
+					load(y, b, bn, L, parts);
+					forward(y, L, roots, parts);
+				} else
+					y = x;
+				forParts(L, parts, [=](Index begin, Index end) {
+					for (Index i = begin; i < end; i++)
+						x[i] = mul(x[i], y[i]);
+				});
+				makeRoots(roots, L, true, parts);
+				inverseTransform(x, L, roots, parts);
+				// The Montgomery form of R / L turns L R^-1 c into c.
+				Blk scale = mul(reciprocal(Blk(L)), rSquared);
+				forParts(L, parts, [=](Index begin, Index end) {
+					for (Index i = begin; i < end; i++)
+						x[i] = mul(x[i], scale);
+				});
+			}
+		};
+
+		/* Garner's method for the residues x1, x2 and x3 of each
+		 * coefficient c:
+		 *     c = v1 + v2 p1 + v3 p1 p2
+		 * with v1 = c mod p1, v2 = (c - v1) / p1 mod p2 and so on. */
+		class Garner {
+			const Prime &p1, &p2, &p3;
+			// Montgomery forms of the constants each step multiplies by
+			Blk inv12, p1mod3, inv123;
+			Blk p12lo, p12hi;
+
+		public:
+			Garner(const Prime &p1, const Prime &p2, const Prime &p3)
+					: p1(p1), p2(p2), p3(p3) {
+				inv12 = p2.reciprocal(p1.p % p2.p);
+				p1mod3 = p3.mul(p1.p % p3.p, p3.rSquared);
+				inv123 = p3.reciprocal(Blk(DoubleBlk(p1.p) * p2.p % p3.p));
+				DoubleBlk p12 = DoubleBlk(p1.p) * p2.p;
+				p12lo = Blk(p12);
+				p12hi = Blk(p12 >> N);
+			}
+
+			/* Blocks [begin, end) of the number whose base-B digits are the
+			 * coefficients, counting only those coefficients; stores what
+			 * they carry into blocks end and end + 1 in c0 and c1. */
+			void recombine(Blk *r, Index begin, Index end, const Blk *x1,
+					const Blk *x2, const Blk *x3, Blk &c0, Blk &c1) const {
+				c0 = 0;
+				c1 = 0;
+				for (Index k = begin; k < end; k++) {
+					Blk v1 = x1[k];
+					// p1 < 3 p2, p1 < 3 p3 and p2 < 2 p3 bound the reductions.
+					Blk v12 = p2.reduce(p2.reduce(v1));
+					Blk v13 = p3.reduce(p3.reduce(v1));
+					Blk v2 = p2.mul(p2.sub(x2[k], v12), inv12);
+					Blk t = p3.sub(p3.sub(x3[k], v13),
+							p3.mul(p3.reduce(v2), p1mod3));
+					Blk v3 = p3.mul(t, inv123);
+
+					DoubleBlk low = DoubleBlk(v2) * p1.p + v1;
+					DoubleBlk mid = DoubleBlk(v3) * p12lo;
+					DoubleBlk high = DoubleBlk(v3) * p12hi;
+					DoubleBlk sum = DoubleBlk(Blk(low)) + Blk(mid) + c0;
+					r[k] = Blk(sum);
+					sum = (sum >> N) + Blk(low >> N) + Blk(mid >> N)
+							+ Blk(high) + c1;
+					c0 = Blk(sum);
+					c1 = Blk(sum >> N) + Blk(high >> N);
+				}
+			}
+		};
+
+		/* r[0 .. n) = the product from the three convolutions, recombined
+		 * in `parts' ranges at once.  Each range starts with no carry; the
+		 * carries out of the ranges are then added in one after another,
+		 * each stopping as soon as it is absorbed. */
+		void recombine(Blk *r, Index n, const Garner &garner, const Blk *x1,
+				const Blk *x2, const Blk *x3, Index parts) {
+			const Index maxParts = 64;
+			if (parts > maxParts)
+				parts = maxParts;
+			Blk carries[2 * maxParts];
+			Index size = (n + parts - 1) / parts;
+			forParts(n, parts, [&](Index begin, Index end) {
+				Index t = begin / size;
+				garner.recombine(r, begin, end, x1, x2, x3,
+						carries[2 * t], carries[2 * t + 1]);
+			});
+			for (Index t = 0; (t + 1) * size < n; t++) {
+				Blk c0 = carries[2 * t], c1 = carries[2 * t + 1];
+				for (Index k = (t + 1) * size; k < n && (c0 | c1) != 0; k++) {
+					Blk sum = r[k] + c0;
+					c0 = c1 + (sum < c0);
+					c1 = 0;
+					r[k] = sum;
+				}
+			}
+		}
+
+		// The largest power of two no more than threads and L / 2.
+		Index powerOfTwoParts(unsigned int threads, Index L) {
+			Index parts = 1;
+			while (parts * 2 <= threads && parts * 2 <= L / 2)
+				parts *= 2;
+			return parts;
+		}
+
+		/* The shared body of multiplyNTT and squareNTT; b is NULL to square.
+		 * On several threads the three convolutions run at once when there
+		 * are threads for all three, each splitting its passes over its
+		 * share; with two threads they run in turn on both. */
+		void productNTT(Blk *r, const Blk *a, Index an, const Blk *b,
+				Index bn) {
+			// The primes, with generators of their multiplicative groups
+			const Prime p1(0x3a00000000000001UL, 3); // 29 * 2^57 + 1
+			const Prime p2(0x2280000000000001UL, 5); // 69 * 2^55 + 1
+			const Prime p3(0x1b00000000000001UL, 5); // 27 * 2^56 + 1
+			const Prime *primes[3] = { &p1, &p2, &p3 };
+			Index n = an + bn, L = 1;
+			while (L < n)
+				L *= 2;
+			Index shorter = (an < bn) ? an : bn;
+			unsigned int threads = (shorter >= parallelThreshold)
+				? multiplyThreads : 1;
+			bool together = threads >= 3;
+			Index parts = powerOfTwoParts(together ? threads / 3 : threads, L);
+
+			/* x1, x2 and x3, then b's transform and the root tables for
+			 * each convolution running at once. */
+			Index sets = together ? 3 : 1;
+			BlockMemory::ScopedArray<Blk> spaceArray((3 + 2 * sets) * Blk(L));
+			Blk *space = spaceArray.get();
+			Blk *x = space, *scratch = x + 3 * L;
+			runTasks(3, together ? 3 : 1, [=](Index i) {
+				Blk *y = scratch + (together ? 2 * i * L : 0);
+				primes[i]->convolve(x + i * L, y, y + L, L, a, an, b, bn, parts);
+			});
+			recombine(r, n, Garner(p1, p2, p3), x, x + L, x + 2 * L,
+					powerOfTwoParts(threads, L));
+		}
+	}
+
+	void multiplyNTT(Blk *r, const Blk *a, Index an, const Blk *b, Index bn) {
+		productNTT(r, a, an, b, bn);
+	}
+
+	void squareNTT(Blk *r, const Blk *a, Index n) {
+		productNTT(r, a, n, NULL, n);
+	}
+}
+
+#endif
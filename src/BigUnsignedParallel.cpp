@@ -0,0 +1,74 @@
+#include "BigUnsignedKernels.hh"
+
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+/* The threads behind the parallel products in BigUnsignedMultiply.cpp and
+ * BigUnsignedNTT.cpp.
+ *
+ * runTasks starts its threads for one fork and joins them at the end; the
+ * products it splits are large enough (see parallelThreshold) that starting
+ * a thread costs a small fraction of a task, and nothing stays running
+ * between products.  The tasks take indices from a shared counter, so a
+ * thread that finishes early picks up the next one.  A task that needs
+ * scratch allocates it on its own thread (see BlockArena.hh). */
+
+namespace {
+	unsigned int hardwareThreads() {
+		unsigned int n = std::thread::hardware_concurrency();
+		return (n == 0) ? 1 : n;
+	}
+}
+
+namespace BigUnsignedKernels {
+
+	unsigned int multiplyThreads = hardwareThreads();
+	Index parallelThreshold = 1024;
+
+	void runTasks(Index count, unsigned int threads,
+			const std::function<void(Index)> &task) {
+		if (threads > count)
+			threads = count;
+		if (threads <= 1) {
+			for (Index i = 0; i < count; i++)
+				task(i);
+			return;
+		}
+
+		std::atomic<Index> next(0);
+		std::exception_ptr failure;
+		std::mutex failureLock;
+		auto work = [&]() {
+			for (Index i; (i = next++) < count; ) {
+				try {
+					task(i);
+				} catch (...) {
+					std::lock_guard<std::mutex> hold(failureLock);
+					if (!failure)
+						failure = std::current_exception();
+				}
+			}
+		};
+
+		/* Reserved first, since a started thread must not be dropped by a
+		 * failed push_back. */
+		std::vector<std::thread> workers;
+		workers.reserve(threads - 1);
+		try {
+			for (unsigned int t = 1; t < threads; t++)
+				workers.emplace_back(work);
+		} catch (...) {
+			/* Out of threads, or of memory to start one (bad_alloc): the
+			 * ones that did start share the tasks. */
+		}
+		work();
+		for (std::thread &worker : workers)
+			worker.join();
+		if (failure)
+			std::rethrow_exception(failure);
+	}
+}
@@ -0,0 +1,132 @@
+#include "BigUnsignedKernels.hh"
+
+/* Block-array bit shifts for BigUnsigned's shift operators and the
+ * normalization step of division.
+ *
+ * Every result block is a funnel shift of two neighbouring source blocks.
+ * The portable loops do one block at a time; on x86-64 processors with AVX2
+ * the same funnel is applied to four blocks at once, using one unaligned
+ * load for the blocks and another, offset by one, for their neighbours.
+ * Both loads of a step are made before its store, and the store never lands
+ * on a block a later step still reads, so the aliasing the declarations
+ * allow still holds. */
+
+#if defined(__x86_64__) && defined(__GNUC__)
+	#include <immintrin.h>
+	#define BIGUNSIGNED_HAVE_AVX2_SHIFTS
+#endif
+
+namespace {
+	using BigUnsignedKernels::Blk;
+	using BigUnsignedKernels::Index;
+	using BigUnsignedKernels::N;
+
+	/* Below this many blocks the portable loops are as fast; see
+	 * bench/kernel_bench.cpp. */
+	const Index vectorShiftBlocks = 16;
+
+	// Copies n blocks; upward when r is above a, downward otherwise.
+	void moveBlocks(Blk *r, const Blk *a, Index n) {
+		if (r > a)
+			for (Index i = n; i > 0; i--)
+				r[i - 1] = a[i - 1];
+		else
+			for (Index i = 0; i < n; i++)
+				r[i] = a[i];
+	}
+
+	/* Blocks [0, n) of a << s, from the top down, for 0 < s < N. */
+	void shiftLeftPortable(Blk *r, const Blk *a, Index n, unsigned int s) {
+		for (Index i = n - 1; i > 0; i--)
+			r[i] = (a[i] << s) | (a[i - 1] >> (N - s));
+		r[0] = a[0] << s;
+	}
+
+	/* Blocks [0, n) of a >> s, from the bottom up, for 0 < s < N. */
+	void shiftRightPortable(Blk *r, const Blk *a, Index n, unsigned int s) {
+		for (Index i = 0; i + 1 < n; i++)
+			r[i] = (a[i] >> s) | (a[i + 1] << (N - s));
+		r[n - 1] = a[n - 1] >> s;
+	}
+
+#ifdef BIGUNSIGNED_HAVE_AVX2_SHIFTS
+	/* Step i stores blocks [i - 4, i) from a[i - 4 ..] and a[i - 5 ..]; the
+	 * bottom blocks go to the portable loop. */
+	__attribute__((target("avx2")))
+	void shiftLeftAVX2(Blk *r, const Blk *a, Index n, unsigned int s) {
+		__m128i left = _mm_cvtsi32_si128(s), right = _mm_cvtsi32_si128(N - s);
+		Index i = n;
+		for (; i >= 5; i -= 4) {
+			__m256i x = _mm256_loadu_si256((const __m256i *)(a + i - 4));
+			__m256i y = _mm256_loadu_si256((const __m256i *)(a + i - 5));
+			_mm256_storeu_si256((__m256i *)(r + i - 4), _mm256_or_si256(
+					_mm256_sll_epi64(x, left), _mm256_srl_epi64(y, right)));
+		}
+		shiftLeftPortable(r, a, i, s);
+	}
+
+	/* Step i stores blocks [i, i + 4) from a[i ..] and a[i + 1 ..]; the top
+	 * blocks go to the portable loop. */
+	__attribute__((target("avx2")))
+	void shiftRightAVX2(Blk *r, const Blk *a, Index n, unsigned int s) {
+		__m128i right = _mm_cvtsi32_si128(s), left = _mm_cvtsi32_si128(N - s);
+		Index i = 0;
+		for (; i + 5 <= n; i += 4) {
+			__m256i x = _mm256_loadu_si256((const __m256i *)(a + i));
+			__m256i y = _mm256_loadu_si256((const __m256i *)(a + i + 1));
+			_mm256_storeu_si256((__m256i *)(r + i), _mm256_or_si256(
+					_mm256_srl_epi64(x, right), _mm256_sll_epi64(y, left)));
+		}
+		shiftRightPortable(r + i, a + i, n - i, s);
+	}
+
+	bool haveAVX2() {
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2");
+	}
+#else
+	bool haveAVX2() {
+		return false;
+	}
+#endif
+}
+
+namespace BigUnsignedKernels {
+
+	bool vectorShifts = haveAVX2();
+
+	Blk shiftLeftBits(Blk *r, const Blk *a, Index n, unsigned int s) {
+		if (n == 0)
+			return 0;
+		if (s == 0) {
+			moveBlocks(r, a, n);
+			return 0;
+		}
+		// Read before r[n - 1] may overwrite it.
+		Blk out = a[n - 1] >> (N - s);
+#ifdef BIGUNSIGNED_HAVE_AVX2_SHIFTS
+		if (vectorShifts && n >= vectorShiftBlocks) {
+			shiftLeftAVX2(r, a, n, s);
+			return out;
+		}
+#endif
+		shiftLeftPortable(r, a, n, s);
+		return out;
+	}
+
+	void shiftRightBits(Blk *r, const Blk *a, Index n, unsigned int s) {
+		if (n == 0)
+			return;
+		if (s == 0) {
+			moveBlocks(r, a, n);
+			return;
+		}
+#ifdef BIGUNSIGNED_HAVE_AVX2_SHIFTS
+		if (vectorShifts && n >= vectorShiftBlocks) {
+			shiftRightAVX2(r, a, n, s);
+			return;
+		}
+#endif
+		shiftRightPortable(r, a, n, s);
+	}
+}
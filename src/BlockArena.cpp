@@ -0,0 +1,158 @@
+#include "BlockArena.hh"
+#include <new>
+#include <vector>
+
+namespace {
+	/* Every array is preceded by a header saying where it came from.  The
+	 * header is 16 bytes so the array keeps operator new's alignment. */
+	struct Header {
+		// The arena, or NULL for an array from operator new
+		BlockArena *arena;
+		// The arena size class
+		size_t sizeClass;
+	};
+	const size_t headerBytes = 16;
+
+	thread_local BlockMemory::Counts threadCounts = { 0, 0, 0 };
+	thread_local BlockArena *currentArena = NULL;
+}
+
+/* Size class k holds pieces of 32 << k bytes, header included.  Pieces bigger
+ * than a quarter chunk get a chunk of their own. */
+class BlockArena {
+	static const size_t chunkBytes = 65536;
+	static const size_t minPieceBytes = 32;
+	static const unsigned int numClasses = 8 * sizeof(size_t);
+
+	// Freed pieces of each class, linked through their first word
+	void *freeLists[numClasses];
+	// Everything allocated with operator new, for release
+	std::vector<void *> chunks;
+	// The unused end of the current chunk
+	char *next, *end;
+	// Pieces handed out and not yet freed, plus one while a scope holds us
+	size_t users;
+
+	~BlockArena() {
+		for (size_t i = 0; i < chunks.size(); i++)
+			::operator delete(chunks[i]);
+	}
+
+	/* The slot is made first, so that a chunk is never allocated and then
+	 * lost; a failed allocation leaves NULL there, which is harmless. */
+	void *newChunk(size_t bytes) {
+		chunks.push_back(NULL);
+		chunks.back() = ::operator new(bytes);
+		threadCounts.arenaChunks++;
+		return chunks.back();
+	}
+
+public:
+	BlockArena() : next(NULL), end(NULL), users(1) {
+		for (unsigned int k = 0; k < numClasses; k++)
+			freeLists[k] = NULL;
+	}
+
+	// Returns a piece of at least bytes bytes and its class.
+	void *take(size_t bytes, size_t &sizeClass) {
+		size_t k = 0, pieceBytes = minPieceBytes;
+		while (pieceBytes < bytes) {
+			pieceBytes <<= 1;
+			k++;
+		}
+		sizeClass = k;
+		void *piece = freeLists[k];
+		if (piece != NULL)
+			freeLists[k] = *static_cast<void **>(piece);
+		else if (pieceBytes > chunkBytes / 4)
+			piece = newChunk(pieceBytes);
+		else {
+			if (size_t(end - next) < pieceBytes) {
+				next = static_cast<char *>(newChunk(chunkBytes));
+				end = next + chunkBytes;
+			}
+			piece = next;
+			next += pieceBytes;
+		}
+		// Counted only once nothing can throw.
+		users++;
+		threadCounts.arenaArrays++;
+		return piece;
+	}
+
+	void give(void *piece, size_t sizeClass) {
+		*static_cast<void **>(piece) = freeLists[sizeClass];
+		freeLists[sizeClass] = piece;
+		release();
+	}
+
+	// Drops one user, deleting the arena with the last.
+	void release() {
+		if (--users == 0)
+			delete this;
+	}
+};
+
+namespace BlockMemory {
+
+	void *allocate(size_t bytes) {
+		Header *header;
+		if (currentArena != NULL) {
+			size_t sizeClass;
+			header = static_cast<Header *>(
+					currentArena->take(bytes + headerBytes, sizeClass));
+			header->arena = currentArena;
+			header->sizeClass = sizeClass;
+		} else {
+			header = static_cast<Header *>(::operator new(bytes + headerBytes));
+			header->arena = NULL;
+			threadCounts.heapArrays++;
+		}
+		return reinterpret_cast<char *>(header) + headerBytes;
+	}
+
+	void deallocate(void *p) {
+		if (p == NULL)
+			return;
+		Header *header = reinterpret_cast<Header *>(
+				static_cast<char *>(p) - headerBytes);
+		if (header->arena != NULL)
+			header->arena->give(header, header->sizeClass);
+		else
+			::operator delete(header);
+	}
+
+	Counts counts() {
+		return threadCounts;
+	}
+
+	void resetCounts() {
+		Counts zero = { 0, 0, 0 };
+		threadCounts = zero;
+	}
+}
+
+ScopedBlockArena::ScopedBlockArena()
+		: arena(new BlockArena), previous(currentArena), open(true) {
+	currentArena = arena;
+}
+
+ScopedBlockArena::~ScopedBlockArena() {
+	close();
+	arena->release();
+}
+
+void ScopedBlockArena::close() {
+	if (open) {
+		currentArena = previous;
+		open = false;
+	}
+}
+
+ScopedHeapBlocks::ScopedHeapBlocks() : previous(currentArena) {
+	currentArena = NULL;
+}
+
+ScopedHeapBlocks::~ScopedHeapBlocks() {
+	currentArena = previous;
+}
@@ -0,0 +1,120 @@
+#ifndef BLOCKARENA_H
+#define BLOCKARENA_H
+
+#include <cstddef>
+
+/* Heap storage for block arrays: the arrays of NumberlikeArray (and so of
+ * BigUnsigned and BigUnsignedInABase) that outgrow their inline storage, and
+ * the scratch arrays of the multiplication and division kernels.
+ *
+ * Arrays normally come from operator new.  While a ScopedBlockArena is open
+ * on the calling thread they come from its arena instead: a freed array goes
+ * on a free list for its power-of-two size class and is handed out again,
+ * and new ones are cut from 64 KB chunks.  Closing the arena sends later
+ * allocations back to wherever they went before; the chunks are released
+ * together once the arena is both closed and out of use.
+ *
+ * Each array remembers where it came from, so it may outlive the scope of
+ * its arena (which then lingers until the array is freed), but it must be
+ * freed on the thread that allocated it.  An algorithm that returns a value
+ * should close its arena and copy the value before returning it; see
+ * BigIntegerAlgorithms.cpp. */
+
+class BlockArena;
+
+namespace BlockMemory {
+
+	// Allocates bytes of storage from the current arena or the heap.
+	void *allocate(size_t bytes);
+	// Frees storage from allocate, which may be NULL.
+	void deallocate(void *p);
+
+	// Typed versions for arrays of blocks (or digits).
+	template <class Blk>
+	Blk *newArray(size_t count) {
+		return static_cast<Blk *>(allocate(count * sizeof(Blk)));
+	}
+	template <class Blk>
+	void deleteArray(Blk *array) {
+		deallocate(array);
+	}
+
+	/* An array from newArray that is deleted with the object, so that
+	 * scratch space is not lost when an exception passes through. */
+	template <class Blk>
+	class ScopedArray {
+		Blk *array;
+
+		// Not copyable
+		ScopedArray(const ScopedArray &);
+		void operator =(const ScopedArray &);
+
+	public:
+		// Holds no array until allocate.
+		ScopedArray() : array(NULL) {}
+		explicit ScopedArray(size_t count) : array(newArray<Blk>(count)) {}
+		~ScopedArray() { deleteArray(array); }
+
+		// Replaces the array held, if any, with a new one of count elements.
+		Blk *allocate(size_t count) {
+			deleteArray(array);
+			array = NULL;
+			array = newArray<Blk>(count);
+			return array;
+		}
+
+		// NULL if nothing has been allocated
+		Blk *get() const { return array; }
+	};
+
+	/* Allocation counts for the calling thread.  heapArrays + arenaChunks
+	 * is the number of trips to operator new. */
+	struct Counts {
+		// Arrays allocated with operator new, outside any arena
+		unsigned long heapArrays;
+		// Arrays handed out by arenas, reused or new
+		unsigned long arenaArrays;
+		// Chunks the arenas allocated with operator new
+		unsigned long arenaChunks;
+	};
+	Counts counts();
+	void resetCounts();
+}
+
+/* Routes the block allocations of the calling thread to a fresh arena for
+ * the lifetime of the object (or until close).  Scopes nest. */
+class ScopedBlockArena {
+	BlockArena *arena;
+	BlockArena *previous;
+	bool open;
+
+	// Not copyable
+	ScopedBlockArena(const ScopedBlockArena &);
+	void operator =(const ScopedBlockArena &);
+
+public:
+	ScopedBlockArena();
+	~ScopedBlockArena();
+
+	/* Stops allocating from the arena before the scope ends.  Arrays
+	 * already allocated stay valid. */
+	void close();
+};
+
+/* Routes the block allocations of the calling thread to the heap for the
+ * lifetime of the object, whatever arena is open, and then back to it.  For
+ * values that are kept past the caller's scope, like a cache, which would
+ * otherwise hold on to all of the caller's arena. */
+class ScopedHeapBlocks {
+	BlockArena *previous;
+
+	// Not copyable
+	ScopedHeapBlocks(const ScopedHeapBlocks &);
+	void operator =(const ScopedHeapBlocks &);
+
+public:
+	ScopedHeapBlocks();
+	~ScopedHeapBlocks();
+};
+
+#endif
@@ -5,16 +5,81 @@
 #include "Concentration.h"
 #include "PeriodicElement.h"
 #include <iostream>
+#include <math.h>
+#include <utility>
 
 using namespace std;
 
 Concentration::Concentration(
 	PeriodicElement element, 
 	BigUnsigned concentration
-):element(element), concentration(concentration){}
+):element(element), concentration(move(concentration)){}
+
+Concentration::Concentration(
+	PeriodicElement element, 
+	double concentration
+):element(element), concentration(doubleToBigUnsigned(concentration)){}
+
+const PeriodicElement &Concentration::getElement() const
+{
+	return element;
+}
+
+BigUnsigned Concentration::getConcentration() const
+{
+	return concentration;
+}
+
+double Concentration::toDouble() const
+{
+	return bigUnsignedToDouble(concentration);
+}
 
 void Concentration::display() const
 {
 	cout << "{concentration: " << concentration 
 		<< ", name:" << element.getName() << "}" << endl;
-}
\ No newline at end of file
+}
+
+/**
+ * Concentrations routinely exceed 2^64 cm^-3, so the conversions split the
+ * double into its 53 bit mantissa and a binary exponent instead of going
+ * through an unsigned long.  Fractional parts are truncated, and infinities
+ * and NaN are rejected.
+ */
+BigUnsigned Concentration::doubleToBigUnsigned(double value)
+{
+	if (!isfinite(value))
+	{
+		throw "Concentration::doubleToBigUnsigned: the value is not finite";
+	}
+	if (value < 1.0)
+	{
+		return BigUnsigned(0);
+	}
+	int exponent;
+	double mantissa = frexp(value, &exponent);
+	BigUnsigned result((unsigned long)ldexp(mantissa, 53));
+	exponent -= 53;
+	if (exponent > 0)
+	{
+		result <<= exponent;
+	}
+	else if (exponent < 0)
+	{
+		result >>= -exponent;
+	}
+	return result;
+}
+
+double Concentration::bigUnsignedToDouble(const BigUnsigned &value)
+{
+	double result = 0.0;
+	BigUnsigned::Index i = value.getLength();
+	while (i > 0)
+	{
+		i--;
+		result = ldexp(result, BigUnsigned::N) + value.getBlock(i);
+	}
+	return result;
+}
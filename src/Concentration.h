@@ -12,11 +12,20 @@ class Concentration
 {
 public:
 	Concentration(PeriodicElement element, BigUnsigned concentration);
+	Concentration(PeriodicElement element, double concentration);
 
 public:
+	const PeriodicElement &getElement() const;
+	BigUnsigned getConcentration() const;
+	//the concentration as stored in a ConcentrationField
+	double toDouble() const;
 	void display() const;
 
+public:
+	static BigUnsigned doubleToBigUnsigned(double value);
+	static double bigUnsignedToDouble(const BigUnsigned &value);
+
 private:
 	PeriodicElement element;
 	BigUnsigned concentration; //cm^-3
-};
\ No newline at end of file
+};
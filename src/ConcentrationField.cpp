@@ -0,0 +1,105 @@
+/**
+ * ConcentrationField.cpp
+ */
+
+#include <string>
+#include <vector>
+
+#include "ConcentrationField.h"
+
+using namespace std;
+
+//constructors
+ConcentrationField::ConcentrationField()
+:_numNodes(0), _head(0)
+{
+
+}
+
+ConcentrationField::ConcentrationField(int numNodes)
+:_numNodes(numNodes), _head(0)
+{
+
+}
+
+//species management
+int ConcentrationField::addSpecies(const PeriodicElement &element)
+{
+	int existing = findSpecies(element.getSymbol());
+	if (existing >= 0)
+	{
+		return existing;
+	}
+
+	_elements.push_back(element);
+	_data.push_back(vector<double>(_head + _numNodes, 0.0));
+	return _elements.size() - 1;
+}
+
+int ConcentrationField::findSpecies(const string &symbol) const
+{
+	for (size_t i = 0; i < _elements.size(); i++)
+	{
+		if (_elements[i].getSymbol() == symbol)
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+void ConcentrationField::resize(int numNodes)
+{
+	for (size_t i = 0; i < _data.size(); i++)
+	{
+		_data[i].erase(_data[i].begin(), _data[i].begin() + _head);
+		_data[i].resize(numNodes, 0.0);
+	}
+	_head = 0;
+	_numNodes = numNodes;
+}
+
+void ConcentrationField::popFront(int count)
+{
+	count = (count < _numNodes) ? count : _numNodes;
+	_head += count;
+	_numNodes -= count;
+}
+
+//getters
+int ConcentrationField::getNumNodes() const
+{
+	return _numNodes;
+}
+
+int ConcentrationField::getNumSpecies() const
+{
+	return _elements.size();
+}
+
+const PeriodicElement &ConcentrationField::getElement(int species) const
+{
+	return _elements.at(species);
+}
+
+double *ConcentrationField::getSpecies(int species)
+{
+	vector<double> &data = _data.at(species);
+	return (_numNodes == 0) ? NULL : &data[_head];
+}
+
+const double *ConcentrationField::getSpecies(int species) const
+{
+	const vector<double> &data = _data.at(species);
+	return (_numNodes == 0) ? NULL : &data[_head];
+}
+
+double ConcentrationField::get(int species, int node) const
+{
+	return _data[species][_head + node];
+}
+
+void ConcentrationField::set(int species, int node, double concentration)
+{
+	_data[species][_head + node] = concentration;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+/**
+ * Contiguous storage for the dopant concentrations of a wafer.
+ *
+ * Concentrations are stored dopant-major: every species owns one dense
+ * array of doubles (cm^-3) indexed by grid node, so sweeps over a single
+ * species run over unit-stride memory.
+ *
+ * The arrays behave like a deque at the front: popFront() drops surface
+ * nodes by advancing a head offset, without moving or reallocating the
+ * remaining data, so a receding surface costs nothing per step.
+ */
+
+#include <vector>
+#include <string>
+#include "PeriodicElement.h"
+
+#ifdef ENABLE_MEMWATCH
+      #include <MemWatch.h>
+      #define new    DEBUG_NEW
+#endif	// ENABLE_MEMWATCH
+
+class ConcentrationField
+{
+public:
+	ConcentrationField();
+	ConcentrationField(int numNodes);
+
+public:
+	//returns the index of the species, adding it if not already present
+	int addSpecies(const PeriodicElement &element);
+	//returns -1 if no species with the given symbol is stored
+	int findSpecies(const std::string &symbol) const;
+
+	//resizes every species array; new nodes are zero
+	void resize(int numNodes);
+	//drops the first count nodes of every species
+	void popFront(int count = 1);
+
+public:
+	int getNumNodes() const;
+	int getNumSpecies() const;
+	const PeriodicElement &getElement(int species) const;
+
+	//unit-stride access to the concentrations of one species
+	double *getSpecies(int species);
+	const double *getSpecies(int species) const;
+
+	double get(int species, int node) const;
+	void set(int species, int node, double concentration);
+
+private:
+	int _numNodes;
+	//index of node 0 in each species array
+	int _head;
+	std::vector<PeriodicElement> _elements;
+	std::vector< std::vector<double> > _data;
+};
@@ -0,0 +1,337 @@
+/**
+ * DiffusionEngine.cpp
+ */
+
+#include <vector>
+#include <algorithm>
+#include <math.h>
+
+#include "DiffusionEngine.h"
+
+using namespace std;
+
+namespace {
+	//cm^2/s -> um^2/s
+	const double CM2_TO_UM2 = 1.0e8;
+	//cm/s -> um/s
+	const double CM_TO_UM = 1.0e4;
+	//Boltzmann constant, eV/K
+	const double BOLTZMANN = 8.617343e-5;
+	const double CELSIUS_TO_KELVIN = 273.15;
+
+	//step size controller limits for runAdaptive
+	const double SAFETY = 0.9;
+	const double MIN_GROWTH = 0.2;
+	const double MAX_GROWTH = 5.0;
+}
+
+//constructors
+DiffusionEngine::DiffusionEngine(Wafer &wafer, int species, double diffusivity)
+:_wafer(wafer), _species(species), _diffusivity(diffusivity),
+	_scheme(CRANK_NICOLSON), _boundary(CAPPED_SURFACE), _surfaceConcentration(0),
+	_transport(0), _segregation(1),
+	_time(0), _arrhenius(false), _d0(0), _activationEnergy(0),
+	_temperature(0), _rampRate(0), _temperatureTime(0),
+	_relativeTolerance(1.0e-3), _absoluteTolerance(1.0e10),
+	_adaptMesh(false), _meshInterval(1)
+{
+
+}
+
+//setters
+void DiffusionEngine::setScheme(Scheme scheme)
+{
+	_scheme = scheme;
+}
+
+void DiffusionEngine::setDiffusivity(double diffusivity)
+{
+	_arrhenius = false;
+	_diffusivity = diffusivity;
+}
+
+void DiffusionEngine::setArrhenius(double d0, double activationEnergy)
+{
+	_arrhenius = true;
+	_d0 = d0;
+	_activationEnergy = activationEnergy;
+}
+
+void DiffusionEngine::setTemperature(double temperature, double rampRate)
+{
+	_temperature = temperature;
+	_rampRate = rampRate;
+	_temperatureTime = _time;
+}
+
+void DiffusionEngine::setTolerances(double relative, double absolute)
+{
+	_relativeTolerance = relative;
+	_absoluteTolerance = absolute;
+}
+
+void DiffusionEngine::setMeshAdaptation(
+	const Wafer::MeshAdaptation &limits, int interval
+) {
+	_adaptMesh = true;
+	_meshLimits = limits;
+	_meshInterval = max(interval, 1);
+}
+
+void DiffusionEngine::setCappedSurface()
+{
+	_boundary = CAPPED_SURFACE;
+}
+
+void DiffusionEngine::setConstantSource(double surfaceConcentration)
+{
+	_boundary = CONSTANT_SOURCE;
+	_surfaceConcentration = surfaceConcentration;
+}
+
+void DiffusionEngine::setSegregation(
+	double transport, double segregation, double outside
+) {
+	_boundary = SEGREGATION;
+	_transport = transport;
+	_segregation = segregation;
+	_surfaceConcentration = outside;
+}
+
+//getters
+DiffusionEngine::Scheme DiffusionEngine::getScheme() const
+{
+	return _scheme;
+}
+
+double DiffusionEngine::getDiffusivity(double time) const
+{
+	if (!_arrhenius)
+	{
+		return _diffusivity;
+	}
+	double kelvin = _temperature + _rampRate * (time - _temperatureTime)
+		+ CELSIUS_TO_KELVIN;
+	return _d0 * exp(-_activationEnergy / (BOLTZMANN * kelvin));
+}
+
+double DiffusionEngine::getDiffusivity() const
+{
+	return getDiffusivity(_time);
+}
+
+DiffusionEngine::SurfaceBoundary DiffusionEngine::getSurfaceBoundary() const
+{
+	return _boundary;
+}
+
+double DiffusionEngine::getTime() const
+{
+	return _time;
+}
+
+//stepping
+
+/**
+ * Builds (V/dt - theta L) c_new = (V/dt + (1 - theta) L) c_old, where V
+ * holds the control volumes and L sums the fluxes D (c[j] - c[i]) / h
+ * into each control volume.  The bulk end is always zero flux; a
+ * segregation surface adds the interface flux h (c0 / m - outside).
+ */
+void DiffusionEngine::assemble(int n, double dt, double diffusivity)
+{
+	if ((int)_diag.size() < n)
+	{
+		_lower.resize(n);
+		_diag.resize(n);
+		_upper.resize(n);
+		_rhs.resize(n);
+	}
+
+	const double *c = _wafer.getField().getSpecies(_species);
+	const double *x = _wafer.getNodes();
+	double theta = (_scheme == BACKWARD_EULER) ? 1.0 : 0.5;
+	double d = diffusivity * CM2_TO_UM2;
+
+	for (int i = 0; i < n; i++)
+	{
+		double volume = _wafer.getControlVolume(i);
+		//conductances to the neighbouring nodes
+		double gl = (i > 0) ? d / (x[i] - x[i - 1]) : 0.0;
+		double gr = (i < n - 1) ? d / (x[i + 1] - x[i]) : 0.0;
+		double flux = 0.0;
+		if (i > 0)
+		{
+			flux += gl * (c[i - 1] - c[i]);
+		}
+		if (i < n - 1)
+		{
+			flux += gr * (c[i + 1] - c[i]);
+		}
+
+		_lower[i] = -theta * gl;
+		_upper[i] = -theta * gr;
+		_diag[i] = volume / dt + theta * (gl + gr);
+		_rhs[i] = volume / dt * c[i] + (1.0 - theta) * flux;
+	}
+
+	if (_boundary == SEGREGATION)
+	{
+		double h = _transport * CM_TO_UM;
+		_diag[0] += theta * h / _segregation;
+		_rhs[0] += (1.0 - theta) * (-h / _segregation * c[0])
+			+ h * _surfaceConcentration;
+	}
+	else if (_boundary == CONSTANT_SOURCE)
+	{
+		_lower[0] = 0.0;
+		_diag[0] = 1.0;
+		_upper[0] = 0.0;
+		_rhs[0] = _surfaceConcentration;
+	}
+}
+
+//one solve over [_time, _time + dt], D taken at the midpoint
+void DiffusionEngine::solveStep(double dt)
+{
+	int n = _wafer.getNumGridPoints();
+	assemble(n, dt, getDiffusivity(_time + 0.5 * dt));
+	double *c = _wafer.getField().getSpecies(_species);
+	_solver.solve(&_lower[0], &_diag[0], &_upper[0], &_rhs[0], c, n);
+	_time += dt;
+}
+
+void DiffusionEngine::step(double dt)
+{
+	if (_wafer.getNumGridPoints() < 2 || dt <= 0)
+	{
+		return;
+	}
+	solveStep(dt);
+}
+
+void DiffusionEngine::run(double time, double dt)
+{
+	int steps = (int)ceil(time / dt);
+	if (steps < 1)
+	{
+		return;
+	}
+	double stepSize = time / steps;
+	for (int i = 0; i < steps; i++)
+	{
+		step(stepSize);
+		adaptMesh(i + 1);
+	}
+}
+
+void DiffusionEngine::adaptMesh(int acceptedSteps)
+{
+	if (_adaptMesh && acceptedSteps % _meshInterval == 0)
+	{
+		_wafer.adaptMesh(_meshLimits);
+	}
+}
+
+//weighted max norm of the difference; <= 1 means the step is accepted
+double DiffusionEngine::estimateError(
+	const double *coarse, const double *fine, int n
+) const {
+	int order = (_scheme == BACKWARD_EULER) ? 1 : 2;
+	//Richardson: the two half steps are off by about diff / (2^p - 1)
+	double scale = 1.0 / ((1 << order) - 1);
+	double error = 0.0;
+	for (int i = 0; i < n; i++)
+	{
+		double tolerance = _absoluteTolerance
+			+ _relativeTolerance * max(fabs(coarse[i]), fabs(fine[i]));
+		error = max(error, scale * fabs(fine[i] - coarse[i]) / tolerance);
+	}
+	return error;
+}
+
+/**
+ * Step doubling: each attempt takes one step of dt and two of dt/2 from the
+ * same start and compares them.  Rejected attempts restore the start state
+ * and retry with a smaller step; the next step size follows the usual
+ * dt * (1/err)^(1/(p+1)) controller.
+ */
+DiffusionEngine::StepStatistics DiffusionEngine::runAdaptive(
+	double time, double initialDt
+) {
+	StepStatistics stats;
+	stats.acceptedSteps = 0;
+	stats.rejectedSteps = 0;
+	stats.solves = 0;
+	stats.minStep = 0;
+	stats.maxStep = 0;
+
+	if (_wafer.getNumGridPoints() < 2 || time <= 0)
+	{
+		return stats;
+	}
+
+	double dt = initialDt;
+	if (dt <= 0)
+	{
+		//a few diffusion times of one grid cell
+		double dx = _wafer.getDx();
+		dt = 10.0 * dx * dx / (getDiffusivity() * CM2_TO_UM2);
+	}
+	int order = (_scheme == BACKWARD_EULER) ? 1 : 2;
+	double end = _time + time;
+
+	while (_time < end)
+	{
+		bool last = (_time + dt >= end);
+		if (last)
+		{
+			dt = end - _time;
+		}
+		int n = _wafer.getNumGridPoints();
+		if ((int)_start.size() < n)
+		{
+			_start.resize(n);
+			_coarse.resize(n);
+		}
+		double *c = _wafer.getField().getSpecies(_species);
+		double startTime = _time;
+		copy(c, c + n, &_start[0]);
+
+		solveStep(dt);
+		copy(c, c + n, &_coarse[0]);
+		copy(&_start[0], &_start[0] + n, c);
+		_time = startTime;
+		solveStep(0.5 * dt);
+		solveStep(0.5 * dt);
+		stats.solves += 3;
+
+		double error = estimateError(&_coarse[0], c, n);
+		double growth = (error > 0)
+			? SAFETY * pow(error, -1.0 / (order + 1)) : MAX_GROWTH;
+		growth = min(MAX_GROWTH, max(MIN_GROWTH, growth));
+
+		if (error <= 1.0)
+		{
+			if (stats.acceptedSteps == 0 || dt < stats.minStep)
+			{
+				stats.minStep = dt;
+			}
+			stats.maxStep = max(stats.maxStep, dt);
+			stats.acceptedSteps++;
+			if (last)
+			{
+				_time = end;
+			}
+			adaptMesh(stats.acceptedSteps);
+		}
+		else
+		{
+			copy(&_start[0], &_start[0] + n, c);
+			_time = startTime;
+			stats.rejectedSteps++;
+		}
+		dt *= growth;
+	}
+	return stats;
+}
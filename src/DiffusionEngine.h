@@ -0,0 +1,131 @@
+#pragma once
+
+/**
+ * Implicit constant-D diffusion of one species of a Wafer.
+ *
+ * The field is discretised with node-centred control volumes (half volumes
+ * on the two end nodes), so with a capped surface the dose is conserved to
+ * round-off.  Each step solves one tridiagonal system with backward Euler
+ * or Crank-Nicolson, both unconditionally stable; the step is not bound by
+ * dt <= dx^2 / 2D.  Coefficient and scratch arrays are kept between steps.
+ *
+ * D is either a constant or follows an Arrhenius law over a (possibly
+ * ramped) furnace temperature.  runAdaptive() picks the step size itself by
+ * step doubling: every step is also taken as two half steps and the
+ * difference is used as a local error estimate against the tolerances, so
+ * the step grows through the slow tail of a drive-in and shrinks on ramps
+ * and fast transients.
+ *
+ * The grid may be non-uniform.  With setMeshAdaptation() the engine calls
+ * Wafer::adaptMesh() between steps; scratch arrays only grow, so the node
+ * count can change freely from step to step.
+ *
+ * Units: depth in um (as on the Wafer), D in cm^2/s, time in s,
+ * temperatures in C, activation energies in eV.
+ */
+
+#include <vector>
+#include "Wafer.h"
+#include "TridiagonalSolver.h"
+
+#ifdef ENABLE_MEMWATCH
+      #include <MemWatch.h>
+      #define new    DEBUG_NEW
+#endif	// ENABLE_MEMWATCH
+
+class DiffusionEngine
+{
+public:
+	enum Scheme { BACKWARD_EULER, CRANK_NICOLSON };
+	enum SurfaceBoundary { CAPPED_SURFACE, CONSTANT_SOURCE, SEGREGATION };
+
+	//counters reported by runAdaptive
+	struct StepStatistics
+	{
+		int acceptedSteps;
+		int rejectedSteps;
+		int solves;
+		double minStep;
+		double maxStep;
+	};
+
+public:
+	DiffusionEngine(Wafer &wafer, int species, double diffusivity);
+
+public:
+	void setScheme(Scheme scheme);
+	void setDiffusivity(double diffusivity);
+	//D = d0 exp(-activationEnergy / kT), replaces a constant diffusivity
+	void setArrhenius(double d0, double activationEnergy);
+	//furnace temperature at the engine's current time and its ramp rate (C/s)
+	void setTemperature(double temperature, double rampRate = 0.0);
+	//relative tolerance and absolute tolerance (cm^-3) for runAdaptive
+	void setTolerances(double relative, double absolute);
+	//adapts the wafer mesh after every interval accepted steps
+	void setMeshAdaptation(const Wafer::MeshAdaptation &limits, int interval = 1);
+	//zero flux through the surface - constant dose drive-in
+	void setCappedSurface();
+	//surface node held at the given concentration (cm^-3) - predep
+	void setConstantSource(double surfaceConcentration);
+	/* flux out of the surface of h (c0 / m - outside), with h the interface
+	 * transport coefficient (cm/s), m the segregation coefficient
+	 * c_inside / c_outside and outside the concentration across the
+	 * interface (cm^-3) - e.g. a growing oxide */
+	void setSegregation(double transport, double segregation, double outside);
+
+public:
+	Scheme getScheme() const;
+	//diffusivity at the given time (s), cm^2/s
+	double getDiffusivity(double time) const;
+	double getDiffusivity() const;
+	SurfaceBoundary getSurfaceBoundary() const;
+	double getTime() const;
+
+public:
+	//advances the species field by dt seconds
+	void step(double dt);
+	//advances by time seconds in steps of at most dt
+	void run(double time, double dt);
+	/* advances by time seconds with error-controlled steps, starting from
+	 * initialDt (or a guess from the grid when it is not positive) */
+	StepStatistics runAdaptive(double time, double initialDt = 0.0);
+
+private:
+	void assemble(int n, double dt, double diffusivity);
+	void solveStep(double dt);
+	double estimateError(const double *coarse, const double *fine, int n) const;
+	void adaptMesh(int acceptedSteps);
+
+private:
+	Wafer &_wafer;
+	int _species;
+	double _diffusivity;
+	Scheme _scheme;
+	SurfaceBoundary _boundary;
+	double _surfaceConcentration;
+	double _transport;
+	double _segregation;
+	double _time;
+
+	bool _arrhenius;
+	double _d0;
+	double _activationEnergy;
+	double _temperature;
+	double _rampRate;
+	double _temperatureTime;
+
+	double _relativeTolerance;
+	double _absoluteTolerance;
+
+	bool _adaptMesh;
+	Wafer::MeshAdaptation _meshLimits;
+	int _meshInterval;
+
+	TridiagonalSolver _solver;
+	std::vector<double> _lower;
+	std::vector<double> _diag;
+	std::vector<double> _upper;
+	std::vector<double> _rhs;
+	std::vector<double> _start;
+	std::vector<double> _coarse;
+};
@@ -0,0 +1,172 @@
+/**
+ * DopantTable.cpp
+ */
+
+#include "DopantTable.h"
+#include "PeriodicElement.h"
+#include <map>
+#include <vector>
+#include <math.h>
+
+using namespace std;
+
+namespace {
+	const int BORON = 5;
+	const int PHOSPHORUS = 15;
+	const int ARSENIC = 33;
+
+	//Boltzmann constant, eV/K
+	const double BOLTZMANN = 8.617343e-5;
+	const double CELSIUS_TO_KELVIN = 273.15;
+}
+
+DopantTable::DopantTable()
+{
+	initalizeLookupTable();
+}
+
+/**
+ * Diffusivities are Fair's vacancy-charge-state values (Plummer, table
+ * 7-5).  Segregation coefficients are the commonly quoted ones; the
+ * interface transport coefficient is a nominal value fast enough to keep
+ * the interface near equilibrium over furnace times.  Range moments for implants into amorphous silicon are rounded from
+ * the usual LSS / Gibbons tables (Rp and delta Rp good to about 10%); the
+ * skewness and kurtosis values sit inside the Pearson IV region.
+ */
+void DopantTable::initalizeLookupTable()
+{
+	lookupTable = map<int, DopantProperties> ();
+
+	addDopant(BORON, false, 0.037, 3.46, 0.72, 3.46, 0, 0);
+	addDopant(PHOSPHORUS, true, 3.85, 3.66, 4.44, 4.00, 44.2, 4.37);
+	addDopant(ARSENIC, true, 0.066, 3.44, 12.0, 4.05, 0, 0);
+
+	addSegregation(BORON, 0.3, 1.0e-6);
+	addSegregation(PHOSPHORUS, 10.0, 1.0e-6);
+	addSegregation(ARSENIC, 10.0, 1.0e-6);
+
+	//boron
+	addRange(BORON,  10, 0.0333, 0.0171, -0.35, 3.6);
+	addRange(BORON,  20, 0.0662, 0.0283, -0.50, 3.9);
+	addRange(BORON,  40, 0.1302, 0.0443, -0.70, 4.4);
+	addRange(BORON,  60, 0.1903, 0.0556, -0.85, 4.9);
+	addRange(BORON,  80, 0.2465, 0.0642, -0.95, 5.3);
+	addRange(BORON, 100, 0.2994, 0.0710, -1.05, 5.7);
+	addRange(BORON, 200, 0.5299, 0.0921, -1.20, 6.6);
+
+	//phosphorus
+	addRange(PHOSPHORUS,  10, 0.0139, 0.0069,  0.40, 3.6);
+	addRange(PHOSPHORUS,  20, 0.0253, 0.0119,  0.35, 3.5);
+	addRange(PHOSPHORUS,  40, 0.0486, 0.0212,  0.25, 3.4);
+	addRange(PHOSPHORUS,  60, 0.0730, 0.0298,  0.15, 3.3);
+	addRange(PHOSPHORUS,  80, 0.0976, 0.0378,  0.05, 3.2);
+	addRange(PHOSPHORUS, 100, 0.1238, 0.0456, -0.05, 3.2);
+	addRange(PHOSPHORUS, 200, 0.2539, 0.0775, -0.35, 3.5);
+
+	//arsenic
+	addRange(ARSENIC,  10, 0.0097, 0.0036, 0.60, 4.0);
+	addRange(ARSENIC,  20, 0.0159, 0.0059, 0.55, 3.9);
+	addRange(ARSENIC,  40, 0.0269, 0.0099, 0.45, 3.7);
+	addRange(ARSENIC,  60, 0.0372, 0.0134, 0.40, 3.6);
+	addRange(ARSENIC,  80, 0.0473, 0.0168, 0.35, 3.5);
+	addRange(ARSENIC, 100, 0.0573, 0.0201, 0.30, 3.4);
+	addRange(ARSENIC, 200, 0.1063, 0.0354, 0.15, 3.3);
+}
+
+void DopantTable::addDopant(int atomicNumber, bool donor,
+	double d0, double e0, double d1, double e1, double d2, double e2)
+{
+	DopantProperties &properties = lookupTable[atomicNumber];
+	properties.donor = donor;
+	properties.neutral.d0 = d0;
+	properties.neutral.activationEnergy = e0;
+	properties.single.d0 = d1;
+	properties.single.activationEnergy = e1;
+	properties.doubleCharged.d0 = d2;
+	properties.doubleCharged.activationEnergy = e2;
+}
+
+void DopantTable::addSegregation(int atomicNumber, double segregation,
+	double transport)
+{
+	DopantProperties &properties = lookupTable[atomicNumber];
+	properties.segregation = segregation;
+	properties.interfaceTransport = transport;
+}
+
+//entries must be added in increasing energy
+void DopantTable::addRange(int atomicNumber, double energy,
+	double projectedRange, double straggle, double skewness, double kurtosis)
+{
+	RangeStatistics range;
+	range.energy = energy;
+	range.projectedRange = projectedRange;
+	range.straggle = straggle;
+	range.skewness = skewness;
+	range.kurtosis = kurtosis;
+	lookupTable[atomicNumber].ranges.push_back(range);
+}
+
+bool DopantTable::hasDopant(const PeriodicElement &element) const
+{
+	return lookupTable.count(element.getAtomicNumber()) > 0;
+}
+
+const DopantProperties &DopantTable::getProperties(
+	const PeriodicElement &element
+) const {
+	return lookupTable.at(element.getAtomicNumber());
+}
+
+RangeStatistics DopantTable::getRangeStatistics(
+	const PeriodicElement &element, double energy
+) const {
+	const vector<RangeStatistics> &ranges = getProperties(element).ranges;
+	if (ranges.size() == 1)
+	{
+		return ranges[0];
+	}
+
+	//bracketing pair, or the end pair when extrapolating
+	size_t hi = 1;
+	while (hi + 1 < ranges.size() && ranges[hi].energy < energy)
+	{
+		hi++;
+	}
+	const RangeStatistics &a = ranges[hi - 1];
+	const RangeStatistics &b = ranges[hi];
+	double w = log(energy / a.energy) / log(b.energy / a.energy);
+
+	RangeStatistics range;
+	range.energy = energy;
+	range.projectedRange = a.projectedRange * pow(b.projectedRange / a.projectedRange, w);
+	range.straggle = a.straggle * pow(b.straggle / a.straggle, w);
+	//the shape moments are only interpolated, not extrapolated
+	w = (w < 0) ? 0 : (w > 1) ? 1 : w;
+	range.skewness = a.skewness + w * (b.skewness - a.skewness);
+	range.kurtosis = a.kurtosis + w * (b.kurtosis - a.kurtosis);
+	return range;
+}
+
+double DopantTable::intrinsicCarriers(double temperature)
+{
+	double kelvin = temperature + CELSIUS_TO_KELVIN;
+	return 3.87e16 * pow(kelvin, 1.5) * exp(-0.605 / (BOLTZMANN * kelvin));
+}
+
+double DopantTable::arrhenius(const Arrhenius &term, double temperature)
+{
+	double kelvin = temperature + CELSIUS_TO_KELVIN;
+	return term.d0 * exp(-term.activationEnergy / (BOLTZMANN * kelvin));
+}
+
+double DopantTable::getDiffusivity(
+	const PeriodicElement &element, double temperature, double eta
+) const {
+	const DopantProperties &dopant = getProperties(element);
+	//acceptors see p/ni = ni/n
+	double charge = dopant.donor ? eta : 1.0 / eta;
+	return arrhenius(dopant.neutral, temperature)
+		+ arrhenius(dopant.single, temperature) * charge
+		+ arrhenius(dopant.doubleCharged, temperature) * charge * charge;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+/**
+ * Purpose: per-dopant process data for dopants in silicon, looked up by
+ * PeriodicElement.  Everything a model needs for one dopant is resolved
+ * once per process step, never per grid node.
+ */
+
+#include "PeriodicElement.h"
+#include <vector>
+#include <map>
+
+#ifdef ENABLE_MEMWATCH
+      #include <MemWatch.h>
+      #define new    DEBUG_NEW
+#endif	// ENABLE_MEMWATCH
+
+//implant range moments in silicon at one energy
+struct RangeStatistics
+{
+	double energy;          //keV
+	double projectedRange;  //Rp, um
+	double straggle;        //delta Rp, um
+	double skewness;        //gamma
+	double kurtosis;        //beta
+};
+
+//d0 exp(-activationEnergy / kT)
+struct Arrhenius
+{
+	double d0;               //cm^2/s
+	double activationEnergy; //eV
+};
+
+struct DopantProperties
+{
+	//true for donors (n-type), false for acceptors (p-type)
+	bool donor;
+	/* diffusivity through neutral, singly and doubly charged vacancies;
+	 * the charged ones scale with (n/ni) for donors and (p/ni) for
+	 * acceptors, squared for the doubly charged term */
+	Arrhenius neutral;
+	Arrhenius single;
+	Arrhenius doubleCharged;
+	//equilibrium c_silicon / c_oxide at the Si/SiO2 interface
+	double segregation;
+	//Si/SiO2 interface transport coefficient, cm/s
+	double interfaceTransport;
+	//sorted by energy
+	std::vector<RangeStatistics> ranges;
+};
+
+class DopantTable
+{
+public:
+	DopantTable();
+
+public:
+	bool hasDopant(const PeriodicElement &element) const;
+	const DopantProperties &getProperties(const PeriodicElement &element) const;
+	/* moments at the given energy, interpolated log-log between table
+	 * energies (extrapolated past the ends) */
+	RangeStatistics getRangeStatistics(
+		const PeriodicElement &element, double energy
+	) const;
+
+	//intrinsic carrier concentration of silicon at temperature (C), cm^-3
+	static double intrinsicCarriers(double temperature);
+	static double arrhenius(const Arrhenius &term, double temperature);
+	/* diffusivity (cm^2/s) at temperature (C) with n/ni = eta; eta = 1 gives
+	 * the intrinsic diffusivity */
+	double getDiffusivity(
+		const PeriodicElement &element, double temperature, double eta = 1.0
+	) const;
+
+private:
+	void initalizeLookupTable();
+	void addDopant(int atomicNumber, bool donor,
+		double d0, double e0, double d1, double e1, double d2, double e2);
+	void addSegregation(int atomicNumber, double segregation, double transport);
+	void addRange(int atomicNumber, double energy, double projectedRange,
+		double straggle, double skewness, double kurtosis);
+
+private:
+	//keyed by atomic number
+	std::map<int, DopantProperties> lookupTable;
+};
@@ -0,0 +1,132 @@
+/**
+ * Extraction.cpp
+ */
+
+#include <vector>
+#include <math.h>
+
+#include "Extraction.h"
+
+using namespace std;
+
+namespace {
+	const double ELEMENTARY_CHARGE = 1.602176e-19;
+	const double UM_TO_CM = 1e-4;
+
+	/* Caughey-Thomas parameters, mu = min + (max - min) / (1 + (N / ref)^alpha),
+	 * fitted to Masetti's data (Plummer, table 1-2) */
+	struct MobilityFit
+	{
+		double minimum;
+		double maximum;
+		double reference;
+		double alpha;
+	};
+	const MobilityFit ELECTRONS = { 68.5, 1414.0, 9.20e16, 0.711 };
+	const MobilityFit HOLES = { 44.9, 470.5, 2.23e17, 0.719 };
+}
+
+//constructors
+Extraction::Extraction(const DopantTable &table)
+:_table(table)
+{
+
+}
+
+//functions
+double Extraction::mobility(double concentration, bool electrons)
+{
+	const MobilityFit &fit = electrons ? ELECTRONS : HOLES;
+	return fit.minimum + (fit.maximum - fit.minimum)
+		/ (1.0 + pow(concentration / fit.reference, fit.alpha));
+}
+
+/**
+ * The net doping at a node is summed over the species arrays in the same
+ * loop that integrates the dose, so nothing per node is stored.  Until the
+ * junction is found each interval also adds mu |net| to the conductance;
+ * on the interval holding the junction only the part above it counts, and
+ * |net| falls to zero at the junction.  The majority carrier is set by the
+ * sign of the net doping at the surface.
+ */
+Extraction::Result Extraction::extract(const Wafer &wafer, int species)
+{
+	const ConcentrationField &field = wafer.getField();
+	int numSpecies = field.getNumSpecies();
+	int n = wafer.getNumGridPoints();
+	const double *x = wafer.getNodes();
+
+	if ((int)_species.size() < numSpecies)
+	{
+		_species.resize(numSpecies);
+		_signs.resize(numSpecies);
+	}
+	for (int s = 0; s < numSpecies; s++)
+	{
+		const PeriodicElement &element = field.getElement(s);
+		_species[s] = field.getSpecies(s);
+		_signs[s] = !_table.hasDopant(element) ? 0.0
+			: (_table.getProperties(element).donor ? 1.0 : -1.0);
+	}
+
+	Result result;
+	result.dose = 0.0;
+	result.junctionDepth = 0.0;
+	result.sheetResistance = 0.0;
+	if (n < 1)
+	{
+		return result;
+	}
+
+	const double *c = field.getSpecies(species);
+	double dose = 0.0;
+	double conductance = 0.0;
+	bool electrons = true;
+	bool inLayer = true;
+	double lastNet = 0.0;
+	double lastTerm = 0.0;
+	for (int i = 0; i < n; i++)
+	{
+		double net = 0.0;
+		double total = 0.0;
+		for (int s = 0; s < numSpecies; s++)
+		{
+			double value = _species[s][i];
+			net += _signs[s] * value;
+			total += fabs(_signs[s]) * value;
+		}
+
+		if (i == 0)
+		{
+			electrons = (net > 0);
+			inLayer = (net != 0);
+			lastNet = net;
+			lastTerm = inLayer ? mobility(total, electrons) * fabs(net) : 0.0;
+			continue;
+		}
+
+		double h = x[i] - x[i - 1];
+		dose += 0.5 * (c[i - 1] + c[i]) * h;
+		if (!inLayer)
+		{
+			continue;
+		}
+		if ((net > 0) != (lastNet > 0))
+		{
+			double junction = x[i - 1] + h * lastNet / (lastNet - net);
+			conductance += 0.5 * lastTerm * (junction - x[i - 1]);
+			result.junctionDepth = junction - x[0];
+			inLayer = false;
+			continue;
+		}
+		double term = mobility(total, electrons) * fabs(net);
+		conductance += 0.5 * (lastTerm + term) * h;
+		lastNet = net;
+		lastTerm = term;
+	}
+
+	conductance *= ELEMENTARY_CHARGE * UM_TO_CM;
+	result.dose = dose * UM_TO_CM;
+	result.sheetResistance = (conductance > 0) ? 1.0 / conductance : 0.0;
+	return result;
+}
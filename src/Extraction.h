@@ -0,0 +1,59 @@
+#pragma once
+
+/**
+ * Level 1 outputs of a Wafer: dose, junction depth and sheet resistance.
+ *
+ * extract() gets all three from one pass over the nodes, reading every
+ * species array at unit stride and keeping only running sums:
+ *  - the dose is the trapezoid rule over the nodes, which on this grid is
+ *    the same as summing concentration times control volume;
+ *  - the junction is the first sign change of the net doping below the
+ *    surface, placed by linear interpolation between the two nodes;
+ *  - the sheet resistance is 1 / (q integral mu(N) |net| dx) over the layer
+ *    above the junction, with the majority-carrier mobility following the
+ *    Caughey-Thomas fit of Masetti's data at the total dopant concentration.
+ *
+ * Only species listed in the DopantTable count towards the net doping.
+ * Species pointers and signs live in scratch arrays that only grow, so an
+ * Extraction reused across steps does not allocate.
+ */
+
+#include <vector>
+#include "Wafer.h"
+#include "DopantTable.h"
+
+#ifdef ENABLE_MEMWATCH
+      #include <MemWatch.h>
+      #define new    DEBUG_NEW
+#endif	// ENABLE_MEMWATCH
+
+class Extraction
+{
+public:
+	struct Result
+	{
+		//cm^-2
+		double dose;
+		//um below the current surface, 0 if the net doping never changes sign
+		double junctionDepth;
+		//ohm / square; the whole wafer if there is no junction
+		double sheetResistance;
+	};
+
+public:
+	Extraction(const DopantTable &table);
+
+public:
+	//low-field mobility (cm^2/Vs) at a total dopant concentration (cm^-3)
+	static double mobility(double concentration, bool electrons);
+
+public:
+	//dose of the given species and the junction / layer of the whole field
+	Result extract(const Wafer &wafer, int species);
+
+private:
+	const DopantTable &_table;
+	std::vector<const double *> _species;
+	//+1 donor, -1 acceptor, 0 not a dopant
+	std::vector<double> _signs;
+};
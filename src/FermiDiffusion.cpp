@@ -0,0 +1,425 @@
+/**
+ * FermiDiffusion.cpp
+ */
+
+#include <vector>
+#include <algorithm>
+#include <math.h>
+
+#include "FermiDiffusion.h"
+#include "BandedSolver.h"
+
+using namespace std;
+
+namespace {
+	//cm^2/s -> um^2/s
+	const double CM2_TO_UM2 = 1.0e8;
+}
+
+//constructors
+FermiDiffusion::FermiDiffusion(
+	Wafer &wafer, const DopantTable &table, double temperature
+)
+:_wafer(wafer), _table(table), _temperature(temperature),
+	_relativeTolerance(1.0e-6), _absoluteTolerance(1.0e6),
+	_maxNewton(20), _maxPicard(200),
+	_sourceSpecies(-1), _surfaceConcentration(0), _ni(0)
+{
+	_stats.steps = 0;
+	_stats.newtonIterations = 0;
+	_stats.picardIterations = 0;
+	_stats.picardFallbacks = 0;
+}
+
+//setters
+void FermiDiffusion::setTemperature(double temperature)
+{
+	_temperature = temperature;
+}
+
+void FermiDiffusion::setTolerances(double relative, double absolute)
+{
+	_relativeTolerance = relative;
+	_absoluteTolerance = absolute;
+}
+
+void FermiDiffusion::setMaxIterations(int newton, int picard)
+{
+	_maxNewton = newton;
+	_maxPicard = picard;
+}
+
+void FermiDiffusion::setCappedSurface()
+{
+	_sourceSpecies = -1;
+}
+
+void FermiDiffusion::setConstantSource(int species, double surfaceConcentration)
+{
+	_sourceSpecies = species;
+	_surfaceConcentration = surfaceConcentration;
+}
+
+//getters
+double FermiDiffusion::getTemperature() const
+{
+	return _temperature;
+}
+
+const FermiDiffusion::SolverStatistics &FermiDiffusion::getStatistics() const
+{
+	return _stats;
+}
+
+const vector<int> &FermiDiffusion::getSpecies() const
+{
+	return _species;
+}
+
+//model
+
+//species can be added between steps (e.g. by an implant), so this runs per step
+void FermiDiffusion::collectSpecies()
+{
+	const ConcentrationField &field = _wafer.getField();
+	_species.clear();
+	_sign.clear();
+	_d0.clear();
+	_d1.clear();
+	_d2.clear();
+	for (int s = 0; s < field.getNumSpecies(); s++)
+	{
+		const PeriodicElement &element = field.getElement(s);
+		if (!_table.hasDopant(element))
+		{
+			continue;
+		}
+		const DopantProperties &dopant = _table.getProperties(element);
+		_species.push_back(s);
+		_sign.push_back(dopant.donor ? 1.0 : -1.0);
+		_d0.push_back(DopantTable::arrhenius(dopant.neutral, _temperature));
+		_d1.push_back(DopantTable::arrhenius(dopant.single, _temperature));
+		_d2.push_back(DopantTable::arrhenius(dopant.doubleCharged, _temperature));
+	}
+	_ni = DopantTable::intrinsicCarriers(_temperature);
+}
+
+/**
+ * n and p from charge neutrality n - p = N, n p = ni^2, taking whichever
+ * root does not cancel.  dn/dN = n / (n + p).
+ */
+void FermiDiffusion::evaluateDiffusivities(const double *u, int n)
+{
+	int S = _species.size();
+	for (int i = 0; i < n; i++)
+	{
+		double net = 0.0;
+		for (int s = 0; s < S; s++)
+		{
+			net += _sign[s] * u[i * S + s];
+		}
+		double root = sqrt(0.25 * net * net + _ni * _ni);
+		double electrons, holes;
+		if (net >= 0)
+		{
+			electrons = 0.5 * net + root;
+			holes = _ni * _ni / electrons;
+		}
+		else
+		{
+			holes = -0.5 * net + root;
+			electrons = _ni * _ni / holes;
+		}
+		double eta = electrons / _ni;
+		double etaPrime = eta / (electrons + holes);
+
+		for (int s = 0; s < S; s++)
+		{
+			double chi = (_sign[s] > 0) ? eta : 1.0 / eta;
+			double chiPrime = (_sign[s] > 0) ? 1.0 : -1.0 / (eta * eta);
+			_d[i * S + s] = _d0[s] + _d1[s] * chi + _d2[s] * chi * chi;
+			_dPrime[i * S + s] = (_d1[s] + 2 * _d2[s] * chi) * chiPrime * etaPrime;
+		}
+	}
+}
+
+//D_face / h between nodes i and j for species s, um/s
+double FermiDiffusion::conductance(int s, int i, int j) const
+{
+	int S = _species.size();
+	const double *x = _wafer.getNodes();
+	return 0.5 * (_d[i * S + s] + _d[j * S + s]) * CM2_TO_UM2 / fabs(x[j] - x[i]);
+}
+
+//R = V (u - u_old) / dt - net flux into the control volume
+void FermiDiffusion::assembleResidual(const double *u, int n, double dt)
+{
+	int S = _species.size();
+	for (int i = 0; i < n; i++)
+	{
+		double volume = _wafer.getControlVolume(i) / dt;
+		for (int s = 0; s < S; s++)
+		{
+			int row = i * S + s;
+			double r = volume * (u[row] - _old[row]);
+			if (i > 0)
+			{
+				r -= conductance(s, i, i - 1) * (u[row - S] - u[row]);
+			}
+			if (i < n - 1)
+			{
+				r -= conductance(s, i, i + 1) * (u[row + S] - u[row]);
+			}
+			_residual[row] = r;
+		}
+	}
+	if (_sourceSpecies >= 0)
+	{
+		for (int s = 0; s < S; s++)
+		{
+			if (_species[s] == _sourceSpecies)
+			{
+				_residual[s] = u[s] - _surfaceConcentration;
+			}
+		}
+	}
+}
+
+/**
+ * dR/du.  Besides the usual linear stencil, every face conductance depends
+ * on the net doping (hence on every species) at both of its nodes, which
+ * gives the off-species entries within the 2S - 1 band.
+ */
+void FermiDiffusion::assembleJacobian(const double *u, int n, double dt)
+{
+	int S = _species.size();
+	int bandwidth = 2 * S - 1;
+	const double *x = _wafer.getNodes();
+	fill(_band.begin(), _band.end(), 0.0);
+
+	for (int i = 0; i < n; i++)
+	{
+		double volume = _wafer.getControlVolume(i) / dt;
+		for (int s = 0; s < S; s++)
+		{
+			int row = i * S + s;
+			if (i == 0 && _species[s] == _sourceSpecies)
+			{
+				_band[BandedSolver::index(row, row, bandwidth)] = 1.0;
+				continue;
+			}
+
+			double diag = volume;
+			//d(flux)/dD terms per unit dD/dN, left and right faces
+			double leftSlope = 0.0, rightSlope = 0.0;
+			if (i > 0)
+			{
+				double g = conductance(s, i, i - 1);
+				diag += g;
+				_band[BandedSolver::index(row, row - S, bandwidth)] -= g;
+				leftSlope = (u[row - S] - u[row]) * 0.5 * CM2_TO_UM2 / (x[i] - x[i - 1]);
+			}
+			if (i < n - 1)
+			{
+				double g = conductance(s, i, i + 1);
+				diag += g;
+				_band[BandedSolver::index(row, row + S, bandwidth)] -= g;
+				rightSlope = (u[row + S] - u[row]) * 0.5 * CM2_TO_UM2 / (x[i + 1] - x[i]);
+			}
+			_band[BandedSolver::index(row, row, bandwidth)] += diag;
+
+			for (int q = 0; q < S; q++)
+			{
+				int col = i * S + q;
+				_band[BandedSolver::index(row, col, bandwidth)] -=
+					_sign[q] * _dPrime[row] * (leftSlope + rightSlope);
+				if (i > 0)
+				{
+					_band[BandedSolver::index(row, col - S, bandwidth)] -=
+						_sign[q] * _dPrime[row - S] * leftSlope;
+				}
+				if (i < n - 1)
+				{
+					_band[BandedSolver::index(row, col + S, bandwidth)] -=
+						_sign[q] * _dPrime[row + S] * rightSlope;
+				}
+			}
+		}
+	}
+}
+
+//weighted max norm; <= 1 means converged
+double FermiDiffusion::updateNorm(const double *delta, const double *u, int count) const
+{
+	double norm = 0.0;
+	for (int k = 0; k < count; k++)
+	{
+		double scale = _absoluteTolerance + _relativeTolerance * fabs(u[k]);
+		norm = max(norm, fabs(delta[k]) / scale);
+	}
+	return norm;
+}
+
+bool FermiDiffusion::newton(int n, double dt)
+{
+	int S = _species.size();
+	int count = n * S;
+	int bandwidth = 2 * S - 1;
+	copy(_old.begin(), _old.begin() + count, _u.begin());
+
+	for (int it = 0; it < _maxNewton; it++)
+	{
+		_stats.newtonIterations++;
+		evaluateDiffusivities(&_u[0], n);
+		assembleResidual(&_u[0], n, dt);
+		assembleJacobian(&_u[0], n, dt);
+		for (int k = 0; k < count; k++)
+		{
+			_residual[k] = -_residual[k];
+		}
+		BandedSolver::solve(&_band[0], &_residual[0], count, bandwidth);
+
+		double norm = updateNorm(&_residual[0], &_u[0], count);
+		if (!(norm == norm))
+		{
+			return false;
+		}
+		for (int k = 0; k < count; k++)
+		{
+			_u[k] = max(0.0, _u[k] + _residual[k]);
+		}
+		if (norm <= 1.0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool FermiDiffusion::picard(int n, double dt)
+{
+	int S = _species.size();
+	int count = n * S;
+	copy(_old.begin(), _old.begin() + count, _u.begin());
+
+	for (int it = 0; it < _maxPicard; it++)
+	{
+		_stats.picardIterations++;
+		evaluateDiffusivities(&_u[0], n);
+		for (int s = 0; s < S; s++)
+		{
+			for (int i = 0; i < n; i++)
+			{
+				double volume = _wafer.getControlVolume(i) / dt;
+				double gl = (i > 0) ? conductance(s, i, i - 1) : 0.0;
+				double gr = (i < n - 1) ? conductance(s, i, i + 1) : 0.0;
+				_lower[i] = -gl;
+				_upper[i] = -gr;
+				_diag[i] = volume + gl + gr;
+				_rhs[i] = volume * _old[i * S + s];
+			}
+			if (_species[s] == _sourceSpecies)
+			{
+				_upper[0] = 0.0;
+				_diag[0] = 1.0;
+				_rhs[0] = _surfaceConcentration;
+			}
+			_solver.solve(&_lower[0], &_diag[0], &_upper[0], &_rhs[0], &_rhs[0], n);
+			for (int i = 0; i < n; i++)
+			{
+				_next[i * S + s] = _rhs[i];
+			}
+		}
+
+		double norm = 0.0;
+		for (int k = 0; k < count; k++)
+		{
+			double scale = _absoluteTolerance + _relativeTolerance * fabs(_next[k]);
+			norm = max(norm, fabs(_next[k] - _u[k]) / scale);
+		}
+		copy(_next.begin(), _next.begin() + count, _u.begin());
+		if (norm <= 1.0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void FermiDiffusion::step(double dt)
+{
+	int n = _wafer.getNumGridPoints();
+	collectSpecies();
+	int S = _species.size();
+	if (n < 2 || S == 0 || dt <= 0)
+	{
+		return;
+	}
+
+	//buffers only grow
+	int count = n * S;
+	if ((int)_old.size() < count)
+	{
+		_old.resize(count);
+		_u.resize(count);
+		_residual.resize(count);
+		_d.resize(count);
+		_dPrime.resize(count);
+		_next.resize(count);
+	}
+	int bandSize = count * BandedSolver::rowWidth(2 * S - 1);
+	if ((int)_band.size() != bandSize)
+	{
+		_band.resize(bandSize);
+	}
+	if ((int)_diag.size() < n)
+	{
+		_lower.resize(n);
+		_diag.resize(n);
+		_upper.resize(n);
+		_rhs.resize(n);
+	}
+
+	ConcentrationField &field = _wafer.getField();
+	for (int s = 0; s < S; s++)
+	{
+		const double *c = field.getSpecies(_species[s]);
+		for (int i = 0; i < n; i++)
+		{
+			_old[i * S + s] = c[i];
+		}
+	}
+
+	if (!newton(n, dt))
+	{
+		_stats.picardFallbacks++;
+		if (!picard(n, dt))
+		{
+			throw "FermiDiffusion::step: nonlinear solve did not converge";
+		}
+	}
+
+	for (int s = 0; s < S; s++)
+	{
+		double *c = field.getSpecies(_species[s]);
+		for (int i = 0; i < n; i++)
+		{
+			c[i] = _u[i * S + s];
+		}
+	}
+	_stats.steps++;
+}
+
+void FermiDiffusion::run(double time, double dt)
+{
+	int steps = (int)ceil(time / dt);
+	if (steps < 1)
+	{
+		return;
+	}
+	double stepSize = time / steps;
+	for (int i = 0; i < steps; i++)
+	{
+		step(stepSize);
+	}
+}
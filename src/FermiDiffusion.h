@@ -0,0 +1,111 @@
+#pragma once
+
+/**
+ * Concentration-dependent (Fermi) diffusion of every dopant on a Wafer.
+ *
+ * Each dopant diffuses with D = D0 + D1 (n/ni) + D2 (n/ni)^2 for donors, or
+ * D0 + D1 (p/ni) for acceptors, where the electron concentration n follows
+ * from the net doping of all dopants together.  That makes each backward
+ * Euler step a nonlinear system coupling every species at a node with its
+ * neighbours.  It is solved by Newton's method on the analytic Jacobian:
+ * with the unknowns interleaved node by node the Jacobian is banded with
+ * bandwidth 2S - 1 for S species (tridiagonal for a single dopant, where the
+ * banded LU is exactly the Thomas algorithm).  If Newton fails to converge
+ * the step is retried with Picard iteration (D frozen at the last iterate,
+ * one tridiagonal solve per species).  Residual, Jacobian and iterate
+ * buffers are kept between steps.
+ *
+ * Only field species listed in the DopantTable take part.  The surface is
+ * capped unless a species is given a constant source; the bulk end is zero
+ * flux.  Units: depth in um, D in cm^2/s, time in s, temperature in C.
+ */
+
+#include <vector>
+#include "Wafer.h"
+#include "DopantTable.h"
+#include "TridiagonalSolver.h"
+
+#ifdef ENABLE_MEMWATCH
+      #include <MemWatch.h>
+      #define new    DEBUG_NEW
+#endif	// ENABLE_MEMWATCH
+
+class FermiDiffusion
+{
+public:
+	//running totals over all steps taken
+	struct SolverStatistics
+	{
+		int steps;
+		int newtonIterations;
+		int picardIterations;
+		int picardFallbacks;
+	};
+
+public:
+	FermiDiffusion(Wafer &wafer, const DopantTable &table, double temperature);
+
+public:
+	void setTemperature(double temperature);
+	void setTolerances(double relative, double absolute);
+	void setMaxIterations(int newton, int picard);
+	void setCappedSurface();
+	//holds the surface node of one field species at a concentration (cm^-3)
+	void setConstantSource(int species, double surfaceConcentration);
+
+public:
+	double getTemperature() const;
+	const SolverStatistics &getStatistics() const;
+	//field species indices that take part, in unknown order
+	const std::vector<int> &getSpecies() const;
+
+public:
+	void step(double dt);
+	void run(double time, double dt);
+
+private:
+	void collectSpecies();
+	void evaluateDiffusivities(const double *u, int n);
+	double conductance(int s, int i, int j) const;
+	void assembleResidual(const double *u, int n, double dt);
+	void assembleJacobian(const double *u, int n, double dt);
+	double updateNorm(const double *delta, const double *u, int count) const;
+	bool newton(int n, double dt);
+	bool picard(int n, double dt);
+
+private:
+	Wafer &_wafer;
+	const DopantTable &_table;
+	double _temperature;
+	double _relativeTolerance;
+	double _absoluteTolerance;
+	int _maxNewton;
+	int _maxPicard;
+	int _sourceSpecies;
+	double _surfaceConcentration;
+	SolverStatistics _stats;
+
+	//per participating species
+	std::vector<int> _species;
+	std::vector<double> _sign;
+	std::vector<double> _d0;
+	std::vector<double> _d1;
+	std::vector<double> _d2;
+	double _ni;
+
+	//interleaved unknowns u[i * S + s]
+	std::vector<double> _old;
+	std::vector<double> _u;
+	std::vector<double> _residual;
+	std::vector<double> _band;
+	//D and dD/dN at each unknown
+	std::vector<double> _d;
+	std::vector<double> _dPrime;
+
+	TridiagonalSolver _solver;
+	std::vector<double> _lower;
+	std::vector<double> _diag;
+	std::vector<double> _upper;
+	std::vector<double> _rhs;
+	std::vector<double> _next;
+};
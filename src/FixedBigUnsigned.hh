@@ -0,0 +1,192 @@
+#ifndef FIXEDBIGUNSIGNED_H
+#define FIXEDBIGUNSIGNED_H
+
+#include <array>
+#include "BigUnsigned.hh"
+#include "BigUnsignedKernels.hh"
+
+/* A FixedBigUnsigned<Limbs> is a nonnegative integer of exactly Limbs blocks,
+ * for code that knows a bound on its numbers in advance.
+ *
+ * The blocks live in a std::array inside the object, least significant first,
+ * with no length, capacity or heap array: leading zero blocks are simply
+ * part of the value.  Every loop runs over a compile-time number of blocks,
+ * so the compiler can unroll it completely.  Under C++17 the arithmetic is
+ * constexpr (see BIGUNSIGNED_CONSTEXPR).
+ *
+ * Like the built-in unsigned types, arithmetic is modulo 2^(N Limbs).  The
+ * put-here add and subtract return the carry or borrow out of the top block,
+ * and multiplyFull gives the whole product in a wider type, for callers that
+ * must not wrap.
+ *
+ * Conversion from a BigUnsigned throws if the value needs more than Limbs
+ * blocks; conversion back never loses anything. */
+template <unsigned int Limbs>
+class FixedBigUnsigned {
+
+public:
+	typedef BigUnsigned::Blk Blk;
+	typedef BigUnsigned::Index Index;
+	typedef BigUnsigned::CmpRes CmpRes;
+	static const unsigned int N = BigUnsignedKernels::N;
+	static const Index limbs = Limbs;
+
+	static_assert(Limbs > 0, "FixedBigUnsigned needs at least one block");
+
+protected:
+	std::array<Blk, Limbs> blk;
+
+public:
+	// Constructs zero.
+	BIGUNSIGNED_CONSTEXPR FixedBigUnsigned() : blk() {}
+
+	// Constructs the value of one block.
+	BIGUNSIGNED_CONSTEXPR FixedBigUnsigned(Blk x) : blk() {
+		blk[0] = x;
+	}
+
+	// Copies a BigUnsigned; throws an exception if it does not fit.
+	explicit FixedBigUnsigned(const BigUnsigned &x) : blk() {
+		if (x.getLength() > Limbs)
+			throw "FixedBigUnsigned::FixedBigUnsigned(const BigUnsigned &): "
+				"Value is too big to fit in the requested width";
+		for (Index i = 0; i < x.getLength(); i++)
+			blk[i] = x.getBlock(i);
+	}
+
+	// The same value as a BigUnsigned.
+	BigUnsigned toBigUnsigned() const {
+		return BigUnsigned(blk.data(), Limbs);
+	}
+
+	// BLOCK ACCESSORS
+	BIGUNSIGNED_CONSTEXPR Blk getBlock(Index i) const { return blk[i]; }
+	BIGUNSIGNED_CONSTEXPR void setBlock(Index i, Blk b) { blk[i] = b; }
+
+	BIGUNSIGNED_CONSTEXPR bool isZero() const {
+		Blk any = 0;
+		for (Index i = 0; i < Limbs; i++)
+			any |= blk[i];
+		return any == 0;
+	}
+
+	// COMPARISONS
+
+	// Compares this to x like BigUnsigned::compareTo.
+	BIGUNSIGNED_CONSTEXPR CmpRes compareTo(const FixedBigUnsigned &x) const {
+		for (Index i = Limbs; i > 0; i--)
+			if (blk[i - 1] != x.blk[i - 1])
+				return (blk[i - 1] > x.blk[i - 1])
+					? BigUnsigned::greater : BigUnsigned::less;
+		return BigUnsigned::equal;
+	}
+
+	BIGUNSIGNED_CONSTEXPR bool operator ==(const FixedBigUnsigned &x) const {
+		Blk diff = 0;
+		for (Index i = 0; i < Limbs; i++)
+			diff |= blk[i] ^ x.blk[i];
+		return diff == 0;
+	}
+	BIGUNSIGNED_CONSTEXPR bool operator !=(const FixedBigUnsigned &x) const {
+		return !operator ==(x);
+	}
+	BIGUNSIGNED_CONSTEXPR bool operator < (const FixedBigUnsigned &x) const { return compareTo(x) == BigUnsigned::less   ; }
+	BIGUNSIGNED_CONSTEXPR bool operator <=(const FixedBigUnsigned &x) const { return compareTo(x) != BigUnsigned::greater; }
+	BIGUNSIGNED_CONSTEXPR bool operator >=(const FixedBigUnsigned &x) const { return compareTo(x) != BigUnsigned::less   ; }
+	BIGUNSIGNED_CONSTEXPR bool operator > (const FixedBigUnsigned &x) const { return compareTo(x) == BigUnsigned::greater; }
+
+	/* PUT-HERE OPERATIONS
+	 * *this may be either operand.  add and subtract return the carry or
+	 * borrow out of the top block. */
+	BIGUNSIGNED_CONSTEXPR Blk add(const FixedBigUnsigned &a,
+			const FixedBigUnsigned &b) {
+		Blk carry = 0;
+		for (Index i = 0; i < Limbs; i++) {
+			Blk s = a.blk[i] + carry;
+			carry = (s < carry);
+			Blk t = s + b.blk[i];
+			carry += (t < s);
+			blk[i] = t;
+		}
+		return carry;
+	}
+	BIGUNSIGNED_CONSTEXPR Blk subtract(const FixedBigUnsigned &a,
+			const FixedBigUnsigned &b) {
+		Blk borrow = 0;
+		for (Index i = 0; i < Limbs; i++) {
+			Blk ai = a.blk[i], bi = b.blk[i];
+			Blk t = ai - bi;
+			Blk borrowOut = (ai < bi) + (t < borrow);
+			blk[i] = t - borrow;
+			borrow = borrowOut;
+		}
+		return borrow;
+	}
+	// The low Limbs blocks of a * b, by the schoolbook method.
+	BIGUNSIGNED_CONSTEXPR void multiply(const FixedBigUnsigned &a,
+			const FixedBigUnsigned &b) {
+		FixedBigUnsigned r;
+		for (Index i = 0; i < Limbs; i++) {
+			Blk carry = 0;
+			for (Index j = 0; i + j < Limbs; j++) {
+				Blk hi = 0;
+				Blk lo = BigUnsignedKernels::mulWide(a.blk[i], b.blk[j], hi);
+				lo += carry;
+				hi += (lo < carry);
+				Blk t = r.blk[i + j] + lo;
+				hi += (t < lo);
+				r.blk[i + j] = t;
+				carry = hi;
+			}
+		}
+		*this = r;
+	}
+
+	// OVERLOADED RETURN-BY-VALUE OPERATORS
+	BIGUNSIGNED_CONSTEXPR FixedBigUnsigned operator +(const FixedBigUnsigned &x) const {
+		FixedBigUnsigned ans;
+		ans.add(*this, x);
+		return ans;
+	}
+	BIGUNSIGNED_CONSTEXPR FixedBigUnsigned operator -(const FixedBigUnsigned &x) const {
+		FixedBigUnsigned ans;
+		ans.subtract(*this, x);
+		return ans;
+	}
+	BIGUNSIGNED_CONSTEXPR FixedBigUnsigned operator *(const FixedBigUnsigned &x) const {
+		FixedBigUnsigned ans;
+		ans.multiply(*this, x);
+		return ans;
+	}
+
+	// OVERLOADED ASSIGNMENT OPERATORS
+	BIGUNSIGNED_CONSTEXPR void operator +=(const FixedBigUnsigned &x) { add(*this, x); }
+	BIGUNSIGNED_CONSTEXPR void operator -=(const FixedBigUnsigned &x) { subtract(*this, x); }
+	BIGUNSIGNED_CONSTEXPR void operator *=(const FixedBigUnsigned &x) { multiply(*this, x); }
+};
+
+// The whole product of a and b, which always fits in A + B blocks.
+template <unsigned int A, unsigned int B>
+BIGUNSIGNED_CONSTEXPR FixedBigUnsigned<A + B> multiplyFull(
+		const FixedBigUnsigned<A> &a, const FixedBigUnsigned<B> &b) {
+	typedef typename FixedBigUnsigned<A>::Blk Blk;
+	typedef typename FixedBigUnsigned<A>::Index Index;
+	FixedBigUnsigned<A + B> r;
+	for (Index i = 0; i < A; i++) {
+		Blk carry = 0;
+		for (Index j = 0; j < B; j++) {
+			Blk hi = 0;
+			Blk lo = BigUnsignedKernels::mulWide(a.getBlock(i), b.getBlock(j), hi);
+			lo += carry;
+			hi += (lo < carry);
+			Blk t = r.getBlock(i + j) + lo;
+			hi += (t < lo);
+			r.setBlock(i + j, t);
+			carry = hi;
+		}
+		r.setBlock(i + B, carry);
+	}
+	return r;
+}
+
+#endif
@@ -11,10 +11,37 @@
 
 using namespace std;
 
-GridPoint::GridPoint(){}
+GridPoint::GridPoint(const ConcentrationField *field, int node)
+:_field(field), _node(node)
+{
+
+}
+
+int GridPoint::getNode() const
+{
+	return _node;
+}
+
+vector<Concentration> GridPoint::getConcentrations() const
+{
+	vector<Concentration> concentrations;
+	for (int s = 0; s < _field->getNumSpecies(); s++)
+	{
+		concentrations.push_back(Concentration(
+			_field->getElement(s), _field->get(s, _node)
+		));
+	}
+	return concentrations;
+}
+
+double GridPoint::getConcentration(int species) const
+{
+	return _field->get(species, _node);
+}
 
 void GridPoint::display() const
 {
+	vector<Concentration> concentrations = getConcentrations();
 	cout << "Concentration:{ " << endl;
 	for (
 		std::vector<Concentration>::const_iterator ita = concentrations.begin(); 
@@ -25,8 +52,3 @@ void GridPoint::display() const
 	}
 	cout << "}" << endl;
 }
-
-void GridPoint::addConcentration(Concentration concentration)
-{
-	concentrations.push_back(concentration);
-}
\ No newline at end of file
@@ -8,18 +8,25 @@
 #include <string>
 #include "PeriodicElement.h"
 #include "Concentration.h"
+#include "ConcentrationField.h"
 
-
+/**
+ * A lightweight view of one node of a wafer's ConcentrationField.
+ * GridPoints do not own any concentrations; they are cheap to create and
+ * only valid while the field they refer to is alive and not resized.
+ */
 class GridPoint
 {
 public:
-	GridPoint();
+	GridPoint(const ConcentrationField *field, int node);
 
 public:
-	std::vector<Concentration> getConcentrations();
-	void addConcentration(Concentration concentration);
+	int getNode() const;
+	std::vector<Concentration> getConcentrations() const;
+	double getConcentration(int species) const;
 	void display() const;
 
 private:
-	std::vector<Concentration> concentrations;
-};
\ No newline at end of file
+	const ConcentrationField *_field;
+	int _node;
+};
@@ -0,0 +1,148 @@
+/**
+ * Implant.cpp
+ */
+
+#include <vector>
+#include <algorithm>
+#include <math.h>
+
+#include "Implant.h"
+#include "VectorMath.h"
+
+using namespace std;
+
+namespace {
+	//cm^-2 -> cm^-3 um
+	const double CM_TO_UM = 1.0e4;
+}
+
+//constructors
+Implant::Implant(const DopantTable &table, const PeriodicElement &element,
+	double energy, double dose)
+:_element(element), _range(table.getRangeStatistics(element, energy)),
+	_dose(dose), _profile(GAUSSIAN)
+{
+
+}
+
+Implant::Implant(const PeriodicElement &element, const RangeStatistics &range,
+	double dose)
+:_element(element), _range(range), _dose(dose), _profile(GAUSSIAN)
+{
+
+}
+
+//setters
+void Implant::setProfile(Profile profile)
+{
+	_profile = profile;
+}
+
+//getters
+Implant::Profile Implant::getProfile() const
+{
+	return _profile;
+}
+
+const RangeStatistics &Implant::getRangeStatistics() const
+{
+	return _range;
+}
+
+double Implant::getDose() const
+{
+	return _dose;
+}
+
+//profiles
+void Implant::gaussianExponents(const double *x, double *exponent, int n) const
+{
+	double rp = _range.projectedRange;
+	double k = -0.5 / (_range.straggle * _range.straggle);
+	for (int i = 0; i < n; i++)
+	{
+		double t = x[i] - rp;
+		exponent[i] = k * t * t;
+	}
+}
+
+/**
+ * f(x) ~ (1 + t^2)^-m exp(-nu atan t), t = (x - lambda) / a, with m, nu,
+ * a and lambda from the four moments (the standard Pearson IV inversion,
+ * r = 2(m - 1)).  Throws if the moments are outside the Pearson IV region.
+ */
+void Implant::pearsonExponents(const double *x, double *exponent, int n) const
+{
+	double mu = _range.projectedRange;
+	double sigma = _range.straggle;
+	double gamma = _range.skewness;
+	double beta1 = gamma * gamma;
+	double beta2 = _range.kurtosis;
+
+	double denom = 2 * beta2 - 3 * beta1 - 6;
+	double r = (denom > 0) ? 6 * (beta2 - beta1 - 1) / denom : 0;
+	double disc = 16 * (r - 1) - beta1 * (r - 2) * (r - 2);
+	if (r <= 3 || disc <= 0)
+	{
+		throw "Implant: skewness and kurtosis are outside the Pearson IV region";
+	}
+	double m = 1 + 0.5 * r;
+	double nu = -r * (r - 2) * gamma / sqrt(disc);
+	double a = sigma * sqrt(disc) / 4;
+	double lambda = mu - (r - 2) * gamma * sigma / 4;
+
+	double peak = -1.0e300;
+	for (int i = 0; i < n; i++)
+	{
+		double t = (x[i] - lambda) / a;
+		exponent[i] = -m * log1p(t * t) - nu * atan(t);
+		peak = max(peak, exponent[i]);
+	}
+	//keep exp() in range, the shape is renormalised anyway
+	for (int i = 0; i < n; i++)
+	{
+		exponent[i] -= peak;
+	}
+}
+
+void Implant::apply(Wafer &wafer)
+{
+	int n = wafer.getNumGridPoints();
+	if (n == 0 || _dose <= 0)
+	{
+		return;
+	}
+	if ((int)_shape.size() < n)
+	{
+		_shape.resize(n);
+	}
+	double *shape = &_shape[0];
+
+	if (_profile == PEARSON_IV)
+	{
+		pearsonExponents(wafer.getNodes(), shape, n);
+	}
+	else
+	{
+		gaussianExponents(wafer.getNodes(), shape, n);
+	}
+	vectorExp(shape, shape, n);
+
+	double area = 0.0;
+	for (int i = 0; i < n; i++)
+	{
+		area += shape[i] * wafer.getControlVolume(i);
+	}
+	if (area <= 0)
+	{
+		return;
+	}
+
+	double scale = _dose * CM_TO_UM / area;
+	ConcentrationField &field = wafer.getField();
+	double *c = field.getSpecies(field.addSpecies(_element));
+	for (int i = 0; i < n; i++)
+	{
+		c[i] += scale * shape[i];
+	}
+}
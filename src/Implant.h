@@ -0,0 +1,59 @@
+#pragma once
+
+/**
+ * Ion implantation into a Wafer.
+ *
+ * The as-implanted profile is a Gaussian in (Rp, delta Rp) or a Pearson IV
+ * that also matches the skewness and kurtosis.  Range moments come from a
+ * DopantTable lookup done once when the Implant is built, so applying it is
+ * one pass over the node depths plus one vectorised exp over the result.
+ * The profile is normalised on the wafer's own mesh, so the dose added to
+ * the species field is exact on that mesh.
+ *
+ * Units: energy in keV, dose in cm^-2, depth in um.
+ */
+
+#include <vector>
+#include "PeriodicElement.h"
+#include "DopantTable.h"
+#include "Wafer.h"
+
+#ifdef ENABLE_MEMWATCH
+      #include <MemWatch.h>
+      #define new    DEBUG_NEW
+#endif	// ENABLE_MEMWATCH
+
+class Implant
+{
+public:
+	enum Profile { GAUSSIAN, PEARSON_IV };
+
+public:
+	//range moments from the table at the given energy
+	Implant(const DopantTable &table, const PeriodicElement &element,
+		double energy, double dose);
+	//explicit range moments
+	Implant(const PeriodicElement &element, const RangeStatistics &range,
+		double dose);
+
+public:
+	void setProfile(Profile profile);
+	Profile getProfile() const;
+	const RangeStatistics &getRangeStatistics() const;
+	double getDose() const;
+
+public:
+	//adds the implanted species to the wafer, creating its field if needed
+	void apply(Wafer &wafer);
+
+private:
+	void gaussianExponents(const double *x, double *exponent, int n) const;
+	void pearsonExponents(const double *x, double *exponent, int n) const;
+
+private:
+	PeriodicElement _element;
+	RangeStatistics _range;
+	double _dose;
+	Profile _profile;
+	std::vector<double> _shape;
+};
@@ -0,0 +1,183 @@
+#include "MontgomeryContext.hh"
+#include "BigUnsignedKernels.hh"
+#include "BlockArena.hh"
+
+namespace {
+	typedef MontgomeryContext::Blk Blk;
+	typedef MontgomeryContext::Index Index;
+
+	/* The block arrays of one computation.  Residues are kept as k-block
+	 * arrays with leading zeros, so every product has the same shape. */
+	class Workspace {
+		Index k;
+		Blk inverse;
+		BlockMemory::ScopedArray<Blk> space;
+		// The modulus and a 2k-block product, in space
+		Blk *m, *t;
+
+	public:
+		Workspace(const BigUnsigned &modulus, Index k, Blk inverse)
+				: k(k), inverse(inverse), space(3 * k) {
+			m = space.get();
+			t = m + k;
+			load(m, modulus);
+		}
+
+		// Copies x < 2^(N k) into the k-block array r.
+		void load(Blk *r, const BigUnsigned &x) const {
+			for (Index i = 0; i < k; i++)
+				r[i] = x.getBlock(i);
+		}
+		BigUnsigned store(const Blk *r) const {
+			return BigUnsigned(r, k);
+		}
+
+		/* r = t R^-1 mod n for t < n R.  Step i adds the multiple of n
+		 * that zeroes block i of t; the carry out of block i + k waits in
+		 * over until step i + 1 adds it to the next block.  What is left
+		 * in the top k blocks (and over) is below 2n. */
+		void reduce(Blk *r) {
+			Blk over = 0;
+			for (Index i = 0; i < k; i++) {
+				Blk carry = BigUnsignedKernels::addMulWord(t + i, m, k,
+						t[i] * inverse);
+				Blk s = t[i + k] + carry;
+				carry = (s < carry);
+				t[i + k] = s + over;
+				over = carry + (t[i + k] < over);
+			}
+			if (over != 0 || BigUnsignedKernels::compareN(t + k, m, k) >= 0)
+				BigUnsignedKernels::subN(r, t + k, m, k);
+			else
+				for (Index i = 0; i < k; i++)
+					r[i] = t[k + i];
+		}
+
+		// r = a b R^-1 mod n for a, b < n.  r may alias a or b.
+		void multiply(Blk *r, const Blk *a, const Blk *b) {
+			if (a == b)
+				BigUnsignedKernels::square(t, a, k);
+			else
+				BigUnsignedKernels::multiply(t, a, k, b, k);
+			reduce(r);
+		}
+
+		// r = a R^-1 mod n.  r may alias a.
+		void leave(Blk *r, const Blk *a) {
+			for (Index i = 0; i < k; i++) {
+				t[i] = a[i];
+				t[k + i] = 0;
+			}
+			reduce(r);
+		}
+	};
+
+	/* Sliding-window width for an exponent of the given length: the width
+	 * that minimizes table building plus one multiplication per window. */
+	unsigned int windowWidth(Index bits) {
+		static const Index limits[] = { 7, 36, 140, 450, 1303, 3529 };
+		unsigned int width = 1;
+		while (width <= 6 && bits > limits[width - 1])
+			width++;
+		return width;
+	}
+}
+
+MontgomeryContext::MontgomeryContext(const BigUnsigned &modulus)
+		: modulus(modulus), k(modulus.getLength()) {
+	if (!modulus.getBit(0))
+		throw "MontgomeryContext: The modulus must be odd";
+	/* Each Newton step x = x (2 - n x) doubles the number of correct low
+	 * bits of n^-1; an odd n is its own inverse mod 8. */
+	Blk n0 = modulus.getBlock(0), x = n0;
+	for (unsigned int bits = 3; bits < BigUnsigned::N; bits *= 2)
+		x *= 2 - n0 * x;
+	inverse = 0 - x;
+	rSquared = 1;
+	rSquared <<= int(2 * BigUnsigned::N * k);
+	rSquared %= modulus;
+}
+
+BigUnsigned MontgomeryContext::toMontgomery(const BigUnsigned &x) const {
+	if (x < modulus)
+		return multiply(x, rSquared);
+	return multiply(x % modulus, rSquared);
+}
+
+BigUnsigned MontgomeryContext::fromMontgomery(const BigUnsigned &x) const {
+	Workspace w(modulus, k, inverse);
+	BlockMemory::ScopedArray<Blk> residue(k);
+	Blk *r = residue.get();
+	w.load(r, x);
+	w.leave(r, r);
+	return w.store(r);
+}
+
+BigUnsigned MontgomeryContext::multiply(const BigUnsigned &a,
+		const BigUnsigned &b) const {
+	Workspace w(modulus, k, inverse);
+	BlockMemory::ScopedArray<Blk> residues(2 * k);
+	Blk *r = residues.get();
+	Blk *s = r + k;
+	w.load(r, a);
+	w.load(s, b);
+	w.multiply(r, r, s);
+	return w.store(r);
+}
+
+/* The exponent is read from the top.  A zero bit costs a squaring; a set bit
+ * starts a window of at most width bits ending in a set bit, whose value v
+ * (odd) costs one squaring per bit and one multiplication by base^v from the
+ * table of odd powers. */
+BigUnsigned MontgomeryContext::modexp(const BigUnsigned &base,
+		const BigUnsigned &exponent) const {
+	Index bits = exponent.bitLength();
+	if (bits == 0)
+		return BigUnsigned(1) % modulus;
+
+	unsigned int width = windowWidth(bits);
+	Index tableSize = Index(1) << (width - 1);
+	Workspace w(modulus, k, inverse);
+	// powers[j] = base^(2j + 1), then base^2 and the accumulator
+	BlockMemory::ScopedArray<Blk> table((tableSize + 2) * k);
+	Blk *powers = table.get();
+	Blk *square = powers + tableSize * k;
+	Blk *acc = square + k;
+	w.load(powers, toMontgomery(base));
+	if (tableSize > 1) {
+		w.multiply(square, powers, powers);
+		for (Index j = 1; j < tableSize; j++)
+			w.multiply(powers + j * k, powers + (j - 1) * k, square);
+	}
+
+	bool started = false;
+	Index i = bits;
+	while (i > 0) {
+		if (!exponent.getBit(i - 1)) {
+			// Not reached before the first window: bit bits - 1 is set.
+			w.multiply(acc, acc, acc);
+			i--;
+			continue;
+		}
+		Index low = (i > width) ? i - width : 0;
+		while (!exponent.getBit(low))
+			low++;
+		Index value = 0;
+		for (Index j = i; j > low; j--)
+			value = (value << 1) | (exponent.getBit(j - 1) ? 1 : 0);
+		const Blk *power = powers + (value >> 1) * k;
+		if (started) {
+			for (Index j = low; j < i; j++)
+				w.multiply(acc, acc, acc);
+			w.multiply(acc, acc, power);
+		} else {
+			for (Index j = 0; j < k; j++)
+				acc[j] = power[j];
+			started = true;
+		}
+		i = low;
+	}
+
+	w.leave(acc, acc);
+	return w.store(acc);
+}
@@ -0,0 +1,49 @@
+#ifndef MONTGOMERYCONTEXT_H
+#define MONTGOMERYCONTEXT_H
+
+#include "BigUnsigned.hh"
+
+/* Modular arithmetic with an odd modulus n in Montgomery form.
+ *
+ * With R = 2^(N * k) for the k blocks of n, the Montgomery form of x is
+ * x R mod n.  The product of two numbers in that form, a b R^-1 mod n, needs
+ * no division: REDC adds multiples of n that clear the low blocks of a b one
+ * at a time and then drops them.  Getting into the form costs one product
+ * with R^2 mod n, which the context precomputes along with
+ * -n^-1 mod 2^N, so a context is worth keeping for repeated exponentiations
+ * with the same modulus. */
+class MontgomeryContext {
+
+public:
+	typedef BigUnsigned::Blk Blk;
+	typedef BigUnsigned::Index Index;
+
+protected:
+	BigUnsigned modulus;
+	// Number of blocks in the modulus
+	Index k;
+	// -modulus^-1 mod 2^N
+	Blk inverse;
+	// R^2 mod modulus
+	BigUnsigned rSquared;
+
+public:
+	// Throws an exception unless the modulus is odd.
+	explicit MontgomeryContext(const BigUnsigned &modulus);
+
+	const BigUnsigned &getModulus() const { return modulus; }
+
+	// x R mod n, and back: x R^-1 mod n
+	BigUnsigned toMontgomery(const BigUnsigned &x) const;
+	BigUnsigned fromMontgomery(const BigUnsigned &x) const;
+
+	// a b R^-1 mod n, for a and b below n
+	BigUnsigned multiply(const BigUnsigned &a, const BigUnsigned &b) const;
+
+	/* base^exponent mod n.  The exponent is scanned with a sliding window
+	 * over a table of odd powers of the base, whose width grows with the
+	 * exponent's length. */
+	BigUnsigned modexp(const BigUnsigned &base, const BigUnsigned &exponent) const;
+};
+
+#endif
@@ -1,14 +1,22 @@
 #ifndef NUMBERLIKEARRAY_H
 #define NUMBERLIKEARRAY_H
 
+#include <utility>
+#include "BlockArena.hh"
+
 // Make sure we have NULL.
 #ifndef NULL
 #define NULL 0
 #endif
 
-/* A NumberlikeArray<Blk> object holds a heap-allocated array of Blk with a
- * length and a capacity and provides basic memory management features.
- * BigUnsigned and BigUnsignedInABase both subclass it.
+/* A NumberlikeArray<Blk> object holds an array of Blk with a length and a
+ * capacity and provides basic memory management features.  BigUnsigned and
+ * BigUnsignedInABase both subclass it.
+ *
+ * Arrays of up to inlineCapacity blocks are kept inside the object itself,
+ * so small numbers (a BigUnsigned below 2^128) never touch the heap; blk
+ * then points at inlineBlk.  Larger arrays are allocated on the heap through
+ * BlockMemory, which uses an arena if one is open (see BlockArena.hh).
  *
  * NumberlikeArray provides no information hiding.  Subclasses should use
  * nonpublic inheritance and manually expose members as desired using
@@ -25,32 +33,35 @@ public:
 	typedef unsigned int Index;
 	// The number of bits in a block, defined below.
 	static const unsigned int N;
+	// The number of blocks that fit in the 16 bytes of inline storage
+	static const Index inlineCapacity = (16 + sizeof(Blk) - 1) / sizeof(Blk);
 
 	// The current allocated capacity of this NumberlikeArray (in blocks)
 	Index cap;
 	// The actual length of the value stored in this NumberlikeArray (in blocks)
 	Index len;
-	// Heap-allocated array of the blocks (can be NULL if len == 0)
+	// The array of the blocks: inlineBlk or a heap array of cap blocks
 	Blk *blk;
+	// Storage for the blocks while they fit
+	Blk inlineBlk[inlineCapacity];
 
 	// Constructs a ``zero'' NumberlikeArray with the given capacity.
-	NumberlikeArray(Index c) : cap(c), len(0) { 
-		blk = (cap > 0) ? (new Blk[cap]) : NULL;
+	NumberlikeArray(Index c) : cap(inlineCapacity), len(0), blk(inlineBlk) {
+		allocate(c);
 	}
 
-	/* Constructs a zero NumberlikeArray without allocating a backing array.
-	 * A subclass that doesn't know the needed capacity at initialization
-	 * time can use this constructor and then overwrite blk without first
-	 * deleting it. */
-	NumberlikeArray() : cap(0), len(0) {
-		blk = NULL;
-	}
+	// Constructs a zero NumberlikeArray using the inline storage.
+	NumberlikeArray() : cap(inlineCapacity), len(0), blk(inlineBlk) {}
 
-	// Destructor.  Note that `delete NULL' is a no-op.
+	// Destructor.  Only a heap array needs deleting.
 	~NumberlikeArray() {
-		delete [] blk;
+		if (!isInline())
+			BlockMemory::deleteArray(blk);
 	}
 
+	// Whether the blocks are in the inline storage.
+	bool isInline() const { return blk == inlineBlk; }
+
 	/* Ensures that the array has at least the requested capacity; may
 	 * destroy the contents. */
 	void allocate(Index c);
@@ -62,9 +73,24 @@ public:
 	// Copy constructor
 	NumberlikeArray(const NumberlikeArray<Blk> &x);
 
-	// Assignment operator
+	/* Assignment operator.  Keeps the existing array when it is big
+	 * enough. */
 	void operator=(const NumberlikeArray<Blk> &x);
 
+	/* Move constructor and assignment: take x's heap array, leaving x zero
+	 * (construction) or holding the array this one had (assignment, where
+	 * x then frees or reuses it).  Inline blocks are copied. */
+	NumberlikeArray(NumberlikeArray<Blk> &&x) noexcept
+			: cap(inlineCapacity), len(0), blk(inlineBlk) {
+		swap(x);
+	}
+	void operator=(NumberlikeArray<Blk> &&x) noexcept {
+		swap(x);
+	}
+
+	// Exchanges the contents of the two objects without allocating.
+	void swap(NumberlikeArray<Blk> &x) noexcept;
+
 	// Constructor that copies from a given array of blocks
 	NumberlikeArray(const Blk *b, Index blen);
 
@@ -90,15 +116,19 @@ public:
 template <class Blk>
 const unsigned int NumberlikeArray<Blk>::N = 8 * sizeof(Blk);
 
+template <class Blk>
+const typename NumberlikeArray<Blk>::Index NumberlikeArray<Blk>::inlineCapacity;
+
 template <class Blk>
 void NumberlikeArray<Blk>::allocate(Index c) {
 	// If the requested capacity is more than the current capacity...
 	if (c > cap) {
 		// Delete the old number array
-		delete [] blk;
+		if (!isInline())
+			BlockMemory::deleteArray(blk);
 		// Allocate the new array
 		cap = c;
-		blk = new Blk[cap];
+		blk = BlockMemory::newArray<Blk>(cap);
 	}
 }
 
@@ -109,22 +139,22 @@ void NumberlikeArray<Blk>::allocateAndCopy(Index c) {
 		Blk *oldBlk = blk;
 		// Allocate the new number array
 		cap = c;
-		blk = new Blk[cap];
+		blk = BlockMemory::newArray<Blk>(cap);
 		// Copy number blocks
 		Index i;
 		for (i = 0; i < len; i++)
 			blk[i] = oldBlk[i];
 		// Delete the old array
-		delete [] oldBlk;
+		if (oldBlk != inlineBlk)
+			BlockMemory::deleteArray(oldBlk);
 	}
 }
 
 template <class Blk>
 NumberlikeArray<Blk>::NumberlikeArray(const NumberlikeArray<Blk> &x)
-		: len(x.len) {
+		: cap(inlineCapacity), len(x.len), blk(inlineBlk) {
 	// Create array
-	cap = len;
-	blk = new Blk[cap];
+	allocate(len);
 	// Copy blocks
 	Index i;
 	for (i = 0; i < len; i++)
@@ -147,11 +177,32 @@ void NumberlikeArray<Blk>::operator=(const NumberlikeArray<Blk> &x) {
 		blk[i] = x.blk[i];
 }
 
+template <class Blk>
+void NumberlikeArray<Blk>::swap(NumberlikeArray<Blk> &x) noexcept {
+	Index i;
+	if (!isInline() && !x.isInline())
+		std::swap(blk, x.blk);
+	else if (isInline() && x.isInline()) {
+		for (i = 0; i < inlineCapacity; i++)
+			std::swap(inlineBlk[i], x.inlineBlk[i]);
+	} else {
+		// The inline blocks move into the other object's unused storage.
+		NumberlikeArray<Blk> &onHeap = isInline() ? x : *this;
+		NumberlikeArray<Blk> &inPlace = isInline() ? *this : x;
+		for (i = 0; i < inPlace.len; i++)
+			onHeap.inlineBlk[i] = inPlace.inlineBlk[i];
+		inPlace.blk = onHeap.blk;
+		onHeap.blk = onHeap.inlineBlk;
+	}
+	std::swap(cap, x.cap);
+	std::swap(len, x.len);
+}
+
 template <class Blk>
 NumberlikeArray<Blk>::NumberlikeArray(const Blk *b, Index blen)
-		: cap(blen), len(blen) {
+		: cap(inlineCapacity), len(blen), blk(inlineBlk) {
 	// Create array
-	blk = new Blk[cap];
+	allocate(len);
 	// Copy blocks
 	Index i;
 	for (i = 0; i < len; i++)
@@ -0,0 +1,178 @@
+/**
+ * OxidationEngine.cpp
+ */
+
+#include <vector>
+#include <math.h>
+
+#include "OxidationEngine.h"
+
+using namespace std;
+
+namespace {
+	//Boltzmann constant, eV/K
+	const double BOLTZMANN = 8.617343e-5;
+	const double CELSIUS_TO_KELVIN = 273.15;
+	const double PER_HOUR = 1.0 / 3600.0;
+	const double CM_TO_UM = 1e4;
+
+	//silicon consumed per unit thickness of oxide grown
+	const double SILICON_PER_OXIDE = 0.44;
+
+	/* Deal-Grove rate constants for (100) silicon (Plummer, table 6-2):
+	 * B in um^2/h, B/A in um/h */
+	struct DealGrove
+	{
+		double parabolic;
+		double parabolicEnergy;
+		double linear;
+		double linearEnergy;
+	};
+	const DealGrove DRY_OXIDE = { 772.0, 1.23, 6.23e6 / 1.68, 2.0 };
+	const DealGrove WET_OXIDE = { 386.0, 0.78, 9.7e7 / 1.68, 2.05 };
+}
+
+//constructors
+OxidationEngine::OxidationEngine(Wafer &wafer, const DopantTable &table,
+	Ambient ambient, double temperature, double initialOxide
+) : _wafer(wafer), _table(table), _temperature(temperature), _time(0),
+	_oxide(initialOxide), _interface(wafer.getNode(0))
+{
+	const DealGrove &rates = (ambient == WET) ? WET_OXIDE : DRY_OXIDE;
+	double kT = BOLTZMANN * (temperature + CELSIUS_TO_KELVIN);
+	_parabolic = rates.parabolic * PER_HOUR * exp(-rates.parabolicEnergy / kT);
+	double linearRate = rates.linear * PER_HOUR * exp(-rates.linearEnergy / kT);
+	_linear = _parabolic / linearRate;
+	_tau = (initialOxide * initialOxide + _linear * initialOxide) / _parabolic;
+}
+
+//getters
+double OxidationEngine::getTime() const
+{
+	return _time;
+}
+
+double OxidationEngine::getOxideThickness() const
+{
+	return _oxide;
+}
+
+double OxidationEngine::getInterfaceDepth() const
+{
+	return _interface;
+}
+
+double OxidationEngine::getOxideDose(int species) const
+{
+	return (species < (int)_oxideDose.size()) ? _oxideDose[species] : 0.0;
+}
+
+double OxidationEngine::oxideThickness(double time) const
+{
+	double a = 0.5 * _linear;
+	return a * (sqrt(1.0 + (time + _tau) * _parabolic / (a * a)) - 1.0);
+}
+
+//functions
+
+//one engine per field species that the table has diffusion data for
+void OxidationEngine::collectSpecies()
+{
+	const ConcentrationField &field = _wafer.getField();
+	int numSpecies = field.getNumSpecies();
+	if ((int)_engines.size() == numSpecies)
+	{
+		return;
+	}
+
+	_oxideDose.resize(numSpecies, 0.0);
+	_consumed.resize(numSpecies, 0.0);
+	for (int s = _engines.size(); s < numSpecies; s++)
+	{
+		const PeriodicElement &element = field.getElement(s);
+		mjh::SharedPtr<DiffusionEngine> engine;
+		if (_table.hasDopant(element))
+		{
+			double diffusivity = _table.getDiffusivity(element, _temperature);
+			engine = mjh::SharedPtr<DiffusionEngine>(
+				new DiffusionEngine(_wafer, s, diffusivity));
+			engine->setScheme(DiffusionEngine::BACKWARD_EULER);
+		}
+		_engines.push_back(engine);
+	}
+}
+
+/**
+ * Grows the oxide over dt, moves the interface by the silicon consumed
+ * (first dropping surface nodes the interface would otherwise pass or
+ * crowd against), moves the dopant in that silicon into the oxide and then
+ * diffuses each species with the interface flux h (c0 / m - c_ox).
+ *
+ * The oxide concentration is taken at the end of the step as well:
+ * c_ox' = (Q + h dt c0' / m) / (x + h dt), which is the same flux with
+ * h x / (x + h dt) in place of h and c_ox = Q / x.  An explicit c_ox would
+ * overshoot whenever h dt exceeds the (initially very thin) oxide.
+ * Whatever leaves the silicon is added to the oxide, so silicon plus
+ * oxide dose is conserved.
+ */
+void OxidationEngine::step(double dt)
+{
+	if (dt <= 0 || _wafer.getNumGridPoints() < 3)
+	{
+		return;
+	}
+	collectSpecies();
+	int numSpecies = _engines.size();
+
+	double oxide = oxideThickness(_time + dt);
+	_interface += SILICON_PER_OXIDE * (oxide - _oxide);
+	_oxide = oxide;
+
+	while (_wafer.getNumGridPoints() >= 3)
+	{
+		double next = _wafer.getNode(1);
+		double gap = _wafer.getNode(2) - next;
+		if (next - _interface >= 0.5 * gap)
+		{
+			break;
+		}
+		_wafer.removeSurfaceNode();
+	}
+	_wafer.moveSurface(_interface, numSpecies > 0 ? &_consumed[0] : NULL);
+
+	for (int s = 0; s < numSpecies; s++)
+	{
+		_oxideDose[s] += _consumed[s];
+		if (_engines[s].get() == NULL)
+		{
+			continue;
+		}
+		const DopantProperties &properties =
+			_table.getProperties(_wafer.getField().getElement(s));
+		//transport scaled so the oxide concentration is implicit too
+		double transport = properties.interfaceTransport;
+		double reach = transport * CM_TO_UM * dt;
+		transport *= _oxide / (_oxide + reach);
+		double outside = (_oxide > 0) ? _oxideDose[s] / _oxide : 0.0;
+		_engines[s]->setSegregation(transport, properties.segregation, outside);
+
+		double before = _wafer.getDose(s);
+		_engines[s]->step(dt);
+		_oxideDose[s] += before - _wafer.getDose(s);
+	}
+	_time += dt;
+}
+
+void OxidationEngine::run(double time, double dt)
+{
+	int steps = (int)ceil(time / dt);
+	if (steps < 1)
+	{
+		return;
+	}
+	double stepSize = time / steps;
+	for (int i = 0; i < steps; i++)
+	{
+		step(stepSize);
+	}
+}
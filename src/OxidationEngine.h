@@ -0,0 +1,75 @@
+#pragma once
+
+/**
+ * Thermal oxidation of a Wafer with dopant redistribution.
+ *
+ * Oxide growth follows Deal-Grove, x^2 + A x = B (t + tau), for dry or wet
+ * ambients on (100) silicon.  Each micron of oxide consumes 0.44 um of
+ * silicon, so the Si/SiO2 interface is a moving boundary: the surface node
+ * tracks the interface and surface nodes are consumed off the front of the
+ * wafer's deque-style node and field buffers as it passes them.  The grid
+ * is never rebuilt, and a step is O(N) with no allocation once the
+ * per-species engines exist.
+ *
+ * Dopant in consumed silicon moves into the oxide, which is treated as
+ * well mixed (one concentration per species).  Every step each species
+ * diffuses in the silicon with its intrinsic D and a segregation flux
+ * h (c_Si / m - c_ox) through the interface, which produces boron
+ * depletion (m < 1) and phosphorus / arsenic pile-up (m > 1).
+ *
+ * Units: depth in um, time in s, temperature in C.
+ */
+
+#include <vector>
+#include "Wafer.h"
+#include "DopantTable.h"
+#include "DiffusionEngine.h"
+#include "MJH_SharedPtr.h"
+
+#ifdef ENABLE_MEMWATCH
+      #include <MemWatch.h>
+      #define new    DEBUG_NEW
+#endif	// ENABLE_MEMWATCH
+
+class OxidationEngine
+{
+public:
+	enum Ambient { DRY, WET };
+
+public:
+	OxidationEngine(Wafer &wafer, const DopantTable &table, Ambient ambient,
+		double temperature, double initialOxide = 0.0);
+
+public:
+	double getTime() const;
+	double getOxideThickness() const;
+	//depth of the Si/SiO2 interface in the wafer's original coordinates
+	double getInterfaceDepth() const;
+	//dopant held in the oxide for a field species, cm^-3 um
+	double getOxideDose(int species) const;
+	//Deal-Grove oxide thickness after the given time (s) from this engine's start
+	double oxideThickness(double time) const;
+
+public:
+	void step(double dt);
+	void run(double time, double dt);
+
+private:
+	void collectSpecies();
+
+private:
+	Wafer &_wafer;
+	const DopantTable &_table;
+	double _temperature;
+	//Deal-Grove parabolic (um^2/s) and linear-parabolic ratio (um)
+	double _parabolic;
+	double _linear;
+	double _tau;
+	double _time;
+	double _oxide;
+	double _interface;
+
+	std::vector<double> _oxideDose;
+	std::vector<double> _consumed;
+	std::vector< mjh::SharedPtr<DiffusionEngine> > _engines;
+};
@@ -27,6 +27,24 @@ void PeriodicElementFactory::initalizeLookupTable()
 	boron.setAtomicNumber(5);
 
 	lookupTable.insert(pair<string, PeriodicElement> ("B", boron));
+
+	//phosphorus - http://www.webelements.com/phosphorus/
+	PeriodicElement phosphorus;
+	phosphorus.setFullName("phosphorus");
+	phosphorus.setSymbol("P");
+	phosphorus.setAtomicWeight(30.973762);
+	phosphorus.setAtomicNumber(15);
+
+	lookupTable.insert(pair<string, PeriodicElement> ("P", phosphorus));
+
+	//arsenic - http://www.webelements.com/arsenic/
+	PeriodicElement arsenic;
+	arsenic.setFullName("arsenic");
+	arsenic.setSymbol("As");
+	arsenic.setAtomicWeight(74.92160);
+	arsenic.setAtomicNumber(33);
+
+	lookupTable.insert(pair<string, PeriodicElement> ("As", arsenic));
 }
 
 PeriodicElement PeriodicElementFactory::getElement(string symbol)
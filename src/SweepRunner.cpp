@@ -0,0 +1,237 @@
+/**
+ * SweepRunner.cpp
+ */
+
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "SweepRunner.h"
+#include "Wafer.h"
+#include "Implant.h"
+#include "DiffusionEngine.h"
+#include "Extraction.h"
+
+using namespace std;
+
+namespace {
+	//run indices owned by one worker; the owner pops the back, thieves the front
+	struct WorkQueue
+	{
+		mutex lock;
+		deque<int> runs;
+	};
+
+	//state shared by the workers of one SweepRunner::run
+	struct SweepContext
+	{
+		const SweepRunner *runner;
+		vector<WorkQueue> *queues;
+		ofstream *output;
+		mutex outputLock;
+		mutex errorLock;
+		//the first exception thrown by a run, rethrown once all workers are joined
+		exception_ptr error;
+	};
+
+	//next run for a worker: its own queue first, then steal from the others
+	bool takeRun(vector<WorkQueue> &queues, int worker, int &run)
+	{
+		int numQueues = queues.size();
+		for (int k = 0; k < numQueues; k++)
+		{
+			WorkQueue &queue = queues[(worker + k) % numQueues];
+			lock_guard<mutex> guard(queue.lock);
+			if (queue.runs.empty())
+			{
+				continue;
+			}
+			if (k == 0)
+			{
+				run = queue.runs.back();
+				queue.runs.pop_back();
+			}
+			else
+			{
+				run = queue.runs.front();
+				queue.runs.pop_front();
+			}
+			return true;
+		}
+		return false;
+	}
+
+	/* no run is ever queued once the workers start, so a worker that finds
+	 * every queue empty is done */
+	void work(SweepContext *context, int worker)
+	{
+		int run;
+		while (takeRun(*context->queues, worker, run))
+		{
+			{
+				lock_guard<mutex> guard(context->errorLock);
+				if (context->error)
+				{
+					return;
+				}
+			}
+
+			try
+			{
+				SweepResult result = context->runner->simulate(run);
+				ostringstream line;
+				line << result.run << '\t' << result.temperature
+					<< '\t' << result.time << '\t' << result.dose
+					<< '\t' << result.energy << '\t' << result.retainedDose
+					<< '\t' << result.junctionDepth
+					<< '\t' << result.sheetResistance << '\n';
+
+				lock_guard<mutex> guard(context->outputLock);
+				*context->output << line.str() << flush;
+			}
+			catch (...)
+			{
+				lock_guard<mutex> guard(context->errorLock);
+				if (!context->error)
+				{
+					context->error = current_exception();
+				}
+			}
+		}
+	}
+}
+
+//constructors
+SweepSpecification::SweepSpecification(const PeriodicElement &dopant,
+	const PeriodicElement &background, double backgroundConcentration
+) : dopant(dopant), background(background),
+	backgroundConcentration(backgroundConcentration),
+	depth(2.0), surfaceDx(0.002), maxDx(0.05), growth(1.05)
+{
+
+}
+
+SweepRunner::SweepRunner(const SweepSpecification &specification, int numThreads)
+:_specification(specification), _numThreads(numThreads)
+{
+	if (_numThreads <= 0)
+	{
+		_numThreads = thread::hardware_concurrency();
+	}
+	if (_numThreads <= 0)
+	{
+		_numThreads = 1;
+	}
+}
+
+//getters
+int SweepRunner::getNumRuns() const
+{
+	return _specification.temperatures.size() * _specification.times.size()
+		* _specification.doses.size() * _specification.energies.size();
+}
+
+int SweepRunner::getNumThreads() const
+{
+	return _numThreads;
+}
+
+//functions
+
+//run indices count through energy fastest, then dose, time and temperature
+SweepResult SweepRunner::simulate(int run) const
+{
+	const SweepSpecification &spec = _specification;
+	SweepResult result;
+	result.run = run;
+	int index = run;
+	result.energy = spec.energies[index % spec.energies.size()];
+	index /= spec.energies.size();
+	result.dose = spec.doses[index % spec.doses.size()];
+	index /= spec.doses.size();
+	result.time = spec.times[index % spec.times.size()];
+	index /= spec.times.size();
+	result.temperature = spec.temperatures[index];
+
+	Wafer wafer(Wafer::gradedNodes(spec.depth, spec.surfaceDx, spec.maxDx, spec.growth),
+		Concentration(spec.background, spec.backgroundConcentration));
+	Implant implant(_table, spec.dopant, result.energy, result.dose);
+	implant.apply(wafer);
+
+	int species = wafer.getField().findSpecies(spec.dopant.getSymbol());
+	DiffusionEngine engine(wafer, species,
+		_table.getDiffusivity(spec.dopant, result.temperature));
+	engine.runAdaptive(result.time);
+
+	Extraction extraction(_table);
+	Extraction::Result extracted = extraction.extract(wafer, species);
+	result.retainedDose = extracted.dose;
+	result.junctionDepth = extracted.junctionDepth;
+	result.sheetResistance = extracted.sheetResistance;
+	return result;
+}
+
+int SweepRunner::run(const string &path)
+{
+	ofstream output(path.c_str());
+	if (!output)
+	{
+		throw "SweepRunner::run: could not open the output file";
+	}
+	output << "#run\ttemperature(C)\ttime(s)\tdose(cm^-2)\tenergy(keV)"
+		<< "\tretainedDose(cm^-2)\txj(um)\tRs(ohm/sq)\n";
+
+	int numRuns = getNumRuns();
+	int numWorkers = min(_numThreads, numRuns);
+	if (numWorkers < 1)
+	{
+		return 0;
+	}
+
+	//contiguous blocks keep neighbouring recipes on one worker
+	vector<WorkQueue> queues(numWorkers);
+	for (int w = 0; w < numWorkers; w++)
+	{
+		int first = (long long)numRuns * w / numWorkers;
+		int last = (long long)numRuns * (w + 1) / numWorkers;
+		for (int r = first; r < last; r++)
+		{
+			queues[w].runs.push_back(r);
+		}
+	}
+
+	SweepContext context;
+	context.runner = this;
+	context.queues = &queues;
+	context.output = &output;
+
+	vector<thread> workers;
+	try
+	{
+		for (int w = 1; w < numWorkers; w++)
+		{
+			workers.push_back(thread(work, &context, w));
+		}
+	}
+	catch (const system_error &)
+	{
+		//out of threads: the workers that started steal the other queues
+	}
+	work(&context, 0);
+	for (size_t w = 0; w < workers.size(); w++)
+	{
+		workers[w].join();
+	}
+
+	if (context.error)
+	{
+		rethrow_exception(context.error);
+	}
+	return numRuns;
+}
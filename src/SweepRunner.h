@@ -0,0 +1,92 @@
+#pragma once
+
+/**
+ * Runs a recipe sweep (temperature x time x dose x energy) as independent
+ * Wafer simulations on a work-stealing thread pool.
+ *
+ * Every run is an implant into a uniformly doped background followed by
+ * an intrinsic constant-D drive-in under a capped surface, after which its
+ * retained dose, junction depth and sheet resistance are extracted (see
+ * Extraction).  Runs build their own Wafer, Implant, DiffusionEngine and
+ * Extraction; the DopantTable is only read, so nothing mutable is shared
+ * between them.
+ *
+ * Each worker owns a deque of run indices, seeded with a contiguous block
+ * of the sweep.  A worker takes work from the back of its own deque and,
+ * once that is empty, steals from the front of the others, so the long
+ * (hot, slow) runs spread out without a central queue.  Results are
+ * streamed to the output file, one line per run, in completion order.
+ */
+
+#include <string>
+#include <vector>
+#include "PeriodicElement.h"
+#include "DopantTable.h"
+
+#ifdef ENABLE_MEMWATCH
+      #include <MemWatch.h>
+      #define new    DEBUG_NEW
+#endif	// ENABLE_MEMWATCH
+
+//the recipes to sweep and the grid each run is simulated on
+struct SweepSpecification
+{
+	SweepSpecification(const PeriodicElement &dopant,
+		const PeriodicElement &background, double backgroundConcentration);
+
+	PeriodicElement dopant;
+	PeriodicElement background;
+	//cm^-3
+	double backgroundConcentration;
+
+	//drive-in temperatures (C) and times (s)
+	std::vector<double> temperatures;
+	std::vector<double> times;
+	//implant doses (cm^-2) and energies (keV)
+	std::vector<double> doses;
+	std::vector<double> energies;
+
+	//graded mesh, see Wafer::gradedNodes (um)
+	double depth;
+	double surfaceDx;
+	double maxDx;
+	double growth;
+};
+
+struct SweepResult
+{
+	int run;
+	double temperature;
+	double time;
+	double dose;
+	double energy;
+	//dopant left in the wafer, cm^-2
+	double retainedDose;
+	//um, 0 if there is no junction
+	double junctionDepth;
+	//ohm / square of the implanted layer
+	double sheetResistance;
+};
+
+class SweepRunner
+{
+public:
+	//numThreads 0 uses one thread per hardware thread
+	SweepRunner(const SweepSpecification &specification, int numThreads = 0);
+
+public:
+	int getNumRuns() const;
+	int getNumThreads() const;
+
+public:
+	//simulates one run of the sweep on the calling thread
+	SweepResult simulate(int run) const;
+	/* simulates every run and writes a line per run to the file at path.
+	 * Returns the number of runs. */
+	int run(const std::string &path);
+
+private:
+	SweepSpecification _specification;
+	DopantTable _table;
+	int _numThreads;
+};
@@ -0,0 +1,47 @@
+/**
+ * TridiagonalSolver.cpp
+ */
+
+#include <vector>
+
+#include "TridiagonalSolver.h"
+
+using namespace std;
+
+TridiagonalSolver::TridiagonalSolver()
+{
+
+}
+
+void TridiagonalSolver::solve(
+	const double *lower, const double *diag, const double *upper,
+	const double *rhs, double *x, int n
+) {
+	if (n <= 0)
+	{
+		return;
+	}
+	//only grows, so a solver reused on one grid allocates once
+	if ((int)_upperPrime.size() < n)
+	{
+		_upperPrime.resize(n);
+	}
+	double *cp = &_upperPrime[0];
+
+	//forward sweep, the modified right hand side goes straight into x
+	double denom = diag[0];
+	cp[0] = upper[0] / denom;
+	x[0] = rhs[0] / denom;
+	for (int i = 1; i < n; i++)
+	{
+		denom = diag[i] - lower[i] * cp[i - 1];
+		cp[i] = upper[i] / denom;
+		x[i] = (rhs[i] - lower[i] * x[i - 1]) / denom;
+	}
+
+	//back substitution
+	for (int i = n - 2; i >= 0; i--)
+	{
+		x[i] -= cp[i] * x[i + 1];
+	}
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+/**
+ * Thomas algorithm for tridiagonal systems.
+ *
+ * Solves lower[i] x[i-1] + diag[i] x[i] + upper[i] x[i+1] = rhs[i] in O(n).
+ * The forward-sweep scratch array is kept between calls, so repeated solves
+ * of the same size do not allocate.  No pivoting is done; the systems coming
+ * out of the diffusion discretisations are diagonally dominant.
+ */
+
+#include <vector>
+
+class TridiagonalSolver
+{
+public:
+	TridiagonalSolver();
+
+public:
+	//lower[0] and upper[n - 1] are ignored.  x may alias rhs.
+	void solve(
+		const double *lower, const double *diag, const double *upper,
+		const double *rhs, double *x, int n
+	);
+
+private:
+	std::vector<double> _upperPrime;
+};
@@ -0,0 +1,72 @@
+/**
+ * VectorMath.cpp
+ */
+
+#include <string.h>
+#include <algorithm>
+
+#include "VectorMath.h"
+
+namespace {
+	const double LOG2E = 1.4426950408889634;
+	//ln 2 split so that n * LN2_HI is exact for |n| < 2^11
+	const double LN2_HI = 6.93147180369123816490e-01;
+	const double LN2_LO = 1.90821492927058770002e-10;
+	//adding 1.5 * 2^52 rounds to an integer held in the low mantissa bits
+	const double ROUNDER = 6755399441055744.0;
+	//past these exp() over/underflows; clamping keeps the bit trick valid
+	const double MAX_ARGUMENT = 708.0;
+	const double MIN_ARGUMENT = -708.0;
+
+	inline long long bitsOf(double x)
+	{
+		long long bits;
+		memcpy(&bits, &x, sizeof(bits));
+		return bits;
+	}
+
+	inline double doubleOf(long long bits)
+	{
+		double x;
+		memcpy(&x, &bits, sizeof(x));
+		return x;
+	}
+}
+
+/**
+ * exp(x) = 2^k exp(r) with k = round(x / ln 2) and |r| <= ln 2 / 2.
+ * exp(r) is a degree 13 Taylor polynomial (relative error below 1e-16 on that
+ * interval) and 2^k is built directly in the exponent bits.
+ */
+void vectorExp(const double *x, double *y, int n)
+{
+	for (int i = 0; i < n; i++)
+	{
+		double v = x[i];
+		v = std::min(v, MAX_ARGUMENT);
+		v = std::max(v, MIN_ARGUMENT);
+
+		double shifted = v * LOG2E + ROUNDER;
+		double k = shifted - ROUNDER;
+		double r = (v - k * LN2_HI) - k * LN2_LO;
+
+		double p = 1.0 / 6227020800.0;
+		p = p * r + 1.0 / 479001600.0;
+		p = p * r + 1.0 / 39916800.0;
+		p = p * r + 1.0 / 3628800.0;
+		p = p * r + 1.0 / 362880.0;
+		p = p * r + 1.0 / 40320.0;
+		p = p * r + 1.0 / 5040.0;
+		p = p * r + 1.0 / 720.0;
+		p = p * r + 1.0 / 120.0;
+		p = p * r + 1.0 / 24.0;
+		p = p * r + 1.0 / 6.0;
+		p = p * r + 0.5;
+		p = p * r + 1.0;
+		p = p * r + 1.0;
+
+		//the low bits of shifted hold k; move k + 1023 into the exponent
+		long long kBits = bitsOf(shifted) - bitsOf(ROUNDER);
+		y[i] = p * doubleOf((kBits + 1023) << 52);
+	}
+}
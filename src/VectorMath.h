@@ -0,0 +1,12 @@
+#pragma once
+
+/**
+ * Elementwise math kernels over contiguous arrays.
+ *
+ * The loops are branch-free and written so the compiler can vectorise them
+ * (SSE2/AVX with optimisation on); they trade the last ulp or two of
+ * accuracy against libm for throughput on whole grid fields.
+ */
+
+//y[i] = exp(x[i]); x and y may be the same array
+void vectorExp(const double *x, double *y, int n);
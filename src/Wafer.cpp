@@ -5,6 +5,7 @@
 #include <iterator>
 #include <vector> 
 #include <iostream> 
+#include <algorithm>
 #include <math.h>
 
 #include "Wafer.h"
@@ -14,11 +15,25 @@ using namespace std;
 
 //constructors
 Wafer::Wafer(double x, double dx, Concentration initialConcentration)
-:_x(x), _dx(dx)
+:_x(x), _dx(dx), _nodeHead(0)
 {
+	//only able to do 1d grids atm
+	int numGridPoints = _x / _dx;
+	_nodes = vector<double>(numGridPoints);
+	for (int i = 0; i < numGridPoints; i++)
+	{
+		_nodes[i] = i * _dx;
+	}
 	initializeGrid(initialConcentration);
 }
 
+Wafer::Wafer(const vector<double> &nodes, Concentration initialConcentration)
+:_x(nodes.empty() ? 0 : nodes.back()), _dx(0), _nodes(nodes), _nodeHead(0)
+{
+	initializeGrid(initialConcentration);
+	updateSpacing();
+}
+
 // Wafer(double x, double dx, double y, double dy)
 // :_x(x), _dx(dx), _y(y), _dy(dy), _z(-1), _dz(-1)
 // {
@@ -35,31 +50,316 @@ Wafer::Wafer(double x, double dx, Concentration initialConcentration)
 
 void Wafer::initializeGrid(Concentration initialConcentration)
 {
-	//only able to do 1d grids atm
-	int numGridPoints = _x / _dx;
-	_gridPoints = vector<GridPoint>(numGridPoints);
+	int numGridPoints = _nodes.size() - _nodeHead;
+	_field = ConcentrationField(numGridPoints);
 
 	//set base concentration
-	
-	for (
-		std::vector<GridPoint>::iterator it = _gridPoints.begin(); 
-		it != _gridPoints.end(); ++it
-	) {
-		it->addConcentration(initialConcentration);
+	int species = _field.addSpecies(initialConcentration.getElement());
+	double base = initialConcentration.toDouble();
+	double *c = _field.getSpecies(species);
+	for (int i = 0; i < numGridPoints; i++)
+	{
+		c[i] = base;
+	}
+}
+
+void Wafer::updateSpacing()
+{
+	int n = getNumGridPoints();
+	const double *x = getNodes();
+	if (n < 2)
+	{
+		return;
 	}
+	_dx = x[1] - x[0];
+	for (int i = 2; i < n; i++)
+	{
+		_dx = min(_dx, x[i] - x[i - 1]);
+	}
+}
 
-	
+vector<double> Wafer::gradedNodes(
+	double x, double surfaceDx, double maxDx, double growth
+) {
+	vector<double> nodes;
+	double depth = 0.0;
+	double h = surfaceDx;
+	while (depth < x)
+	{
+		nodes.push_back(depth);
+		depth += h;
+		h = min(h * growth, maxDx);
+	}
+	//stretch the last interval rather than leave a sliver at the back
+	if (nodes.size() > 1 && x - nodes.back() < 0.5 * (nodes.back() - nodes[nodes.size() - 2]))
+	{
+		nodes.pop_back();
+	}
+	nodes.push_back(x);
+	return nodes;
+}
+
+/**
+ * Works on ln(c) so a decade of change counts the same at 1e20 and 1e15.
+ * Each interval is split into enough equal pieces that the log change
+ * across a piece is within tolerance (never below minDx), and an interior
+ * node is dropped when the merged interval changes by less than half the
+ * tolerance, the node sits on the straight line between its neighbours and
+ * the merged interval fits in maxDx.  Values on new nodes are linearly interpolated
+ * and then every species is rescaled to its old dose.
+ */
+int Wafer::adaptMesh(const MeshAdaptation &limits)
+{
+	int n = getNumGridPoints();
+	const double *x = getNodes();
+	int numSpecies = _field.getNumSpecies();
+	if (n < 2)
+	{
+		return n;
+	}
+
+	//change of ln(c) across node a -> node b, over all species
+	vector<double> logChange(n, 0.0);
+	vector<double> bend(n, 0.0);
+	for (int s = 0; s < numSpecies; s++)
+	{
+		const double *c = _field.getSpecies(s);
+		for (int i = 0; i + 1 < n; i++)
+		{
+			double change = fabs(log(max(c[i + 1], limits.floor) / max(c[i], limits.floor)));
+			logChange[i] = max(logChange[i], change);
+		}
+		for (int i = 1; i + 1 < n; i++)
+		{
+			double w = (x[i] - x[i - 1]) / (x[i + 1] - x[i - 1]);
+			double line = (1 - w) * log(max(c[i - 1], limits.floor))
+				+ w * log(max(c[i + 1], limits.floor));
+			bend[i] = max(bend[i], fabs(log(max(c[i], limits.floor)) - line));
+		}
+	}
+
+	vector<double> nodes;
+	nodes.reserve(n);
+	nodes.push_back(x[0]);
+	//change of ln(c) since the last node that was kept
+	double run = 0.0;
+	for (int i = 0; i + 1 < n; i++)
+	{
+		double left = nodes.back();
+		double right = x[i + 1];
+		run += logChange[i];
+
+		bool drop = i + 2 < n
+			&& run + logChange[i + 1] < 0.5 * limits.tolerance
+			&& bend[i + 1] < 0.25 * limits.tolerance
+			&& x[i + 2] - left <= limits.maxDx;
+		if (drop)
+		{
+			continue;
+		}
+
+		int pieces = (int)ceil(run / limits.tolerance);
+		pieces = min(pieces, (int)floor((right - left) / limits.minDx));
+		pieces = max(pieces, (int)ceil((right - left) / limits.maxDx));
+		pieces = max(pieces, 1);
+		for (int k = 1; k < pieces; k++)
+		{
+			nodes.push_back(left + (right - left) * k / pieces);
+		}
+		nodes.push_back(right);
+		run = 0.0;
+	}
+
+	int m = nodes.size();
+	if (m == n && equal(nodes.begin(), nodes.end(), x))
+	{
+		return n;
+	}
+
+	vector<double> dose(numSpecies);
+	for (int s = 0; s < numSpecies; s++)
+	{
+		dose[s] = getDose(s);
+	}
+
+	//linear transfer onto the new nodes
+	ConcentrationField field(m);
+	for (int s = 0; s < numSpecies; s++)
+	{
+		field.addSpecies(_field.getElement(s));
+		const double *c = _field.getSpecies(s);
+		double *d = field.getSpecies(s);
+		int j = 0;
+		for (int i = 0; i < m; i++)
+		{
+			while (j + 2 < n && x[j + 1] <= nodes[i])
+			{
+				j++;
+			}
+			double w = (nodes[i] - x[j]) / (x[j + 1] - x[j]);
+			w = min(1.0, max(0.0, w));
+			d[i] = (1 - w) * c[j] + w * c[j + 1];
+		}
+	}
+
+	_nodes.swap(nodes);
+	_nodeHead = 0;
+	_field = field;
+	updateSpacing();
+
+	//restore the dose of every species exactly
+	for (int s = 0; s < numSpecies; s++)
+	{
+		double newDose = getDose(s);
+		if (newDose > 0)
+		{
+			double scale = dose[s] / newDose;
+			double *c = _field.getSpecies(s);
+			for (int i = 0; i < m; i++)
+			{
+				c[i] *= scale;
+			}
+		}
+	}
+	return m;
+}
+
+/**
+ * Moving the surface node changes the control volumes of nodes 0 and 1.
+ * The material between the old and new surface leaves the wafer at the
+ * surface concentration; node 0 is then corrected so that each species'
+ * dose drops by exactly that amount, which is returned per species in
+ * consumed (cm^-3 um) when it is not NULL.
+ */
+void Wafer::moveSurface(double depth, double *consumed)
+{
+	int n = getNumGridPoints();
+	if (n < 2)
+	{
+		return;
+	}
+	double *x = &_nodes[_nodeHead];
+	double shift = depth - x[0];
+	double oldVolume0 = getControlVolume(0);
+	double oldVolume1 = getControlVolume(1);
+	x[0] = depth;
+	double newVolume0 = getControlVolume(0);
+	double newVolume1 = getControlVolume(1);
+
+	for (int s = 0; s < _field.getNumSpecies(); s++)
+	{
+		double *c = _field.getSpecies(s);
+		double removed = shift * c[0];
+		double before = oldVolume0 * c[0] + oldVolume1 * c[1];
+		double after = newVolume1 * c[1];
+		c[0] = max(0.0, (before - removed - after) / newVolume0);
+		if (consumed != NULL)
+		{
+			consumed[s] = before - after - newVolume0 * c[0];
+		}
+	}
+	_dx = min(_dx, x[1] - x[0]);
+}
+
+/**
+ * Node 1 takes over the surface position.  Node 2 keeps its concentration
+ * although its control volume grows, so the new surface value is what is
+ * left of the dose of the old first three nodes.
+ */
+void Wafer::removeSurfaceNode()
+{
+	int n = getNumGridPoints();
+	if (n < 3)
+	{
+		return;
+	}
+	double oldVolume0 = getControlVolume(0);
+	double oldVolume1 = getControlVolume(1);
+	double oldVolume2 = getControlVolume(2);
+	_field.popFront();
+	_nodes[_nodeHead + 1] = _nodes[_nodeHead];
+	_nodeHead++;
+	double newVolume0 = getControlVolume(0);
+	double newVolume1 = getControlVolume(1);
+
+	for (int s = 0; s < _field.getNumSpecies(); s++)
+	{
+		//c[-1] is the dropped surface node, still in the buffer
+		double *c = _field.getSpecies(s);
+		double dose = oldVolume0 * c[-1] + oldVolume1 * c[0] + oldVolume2 * c[1];
+		c[0] = max(0.0, (dose - newVolume1 * c[1]) / newVolume0);
+	}
+	updateSpacing();
+}
+
+//getters
+int Wafer::getNumGridPoints() const
+{
+	return _field.getNumNodes();
+}
+
+double Wafer::getX() const
+{
+	return _x;
+}
+
+double Wafer::getDx() const
+{
+	return _dx;
+}
+
+const double *Wafer::getNodes() const
+{
+	return ((int)_nodes.size() == _nodeHead) ? NULL : &_nodes[_nodeHead];
+}
+
+double Wafer::getNode(int node) const
+{
+	return _nodes[_nodeHead + node];
+}
+
+double Wafer::getControlVolume(int node) const
+{
+	int n = getNumGridPoints();
+	const double *x = getNodes();
+	double left = (node > 0) ? x[node] - x[node - 1] : 0.0;
+	double right = (node < n - 1) ? x[node + 1] - x[node] : 0.0;
+	return 0.5 * (left + right);
+}
+
+double Wafer::getDose(int species) const
+{
+	const double *c = _field.getSpecies(species);
+	double dose = 0.0;
+	for (int i = 0; i < getNumGridPoints(); i++)
+	{
+		dose += c[i] * getControlVolume(i);
+	}
+	return dose;
+}
+
+GridPoint Wafer::getGridPoint(int node) const
+{
+	return GridPoint(&_field, node);
+}
+
+ConcentrationField &Wafer::getField()
+{
+	return _field;
+}
+
+const ConcentrationField &Wafer::getField() const
+{
+	return _field;
 }
 
 void Wafer::displayCencentrationToCOUT() const
 {
 	//display the points
 	std::cout << "The contents of _gridPoints are:";
-	for (
-		std::vector<GridPoint>::const_iterator ita = _gridPoints.begin(); 
-		ita != _gridPoints.end(); ++ita
-	) {
-		ita->display();
+	for (int i = 0; i < _field.getNumNodes(); i++)
+	{
+		getGridPoint(i).display();
 	}
 	std::cout << '\n';
 }
@@ -68,4 +368,4 @@ void Wafer::displayCencentrationToCOUT() const
 void createPlot()
 {
 	
-}
\ No newline at end of file
+}
@@ -2,11 +2,22 @@
 
 /**
  * Encapsulates the simulation grid.
+ *
+ * The 1d grid is a list of node depths (um) that need not be evenly spaced:
+ * a graded mesh can put fine nodes at the surface and coarse ones in the
+ * bulk, and adaptMesh() refines or coarsens it between time steps.  Each
+ * node owns the control volume halfway to its neighbours; dose is the sum of
+ * concentration times control volume.
+ *
+ * The surface can recede (e.g. silicon consumed by oxidation): surface
+ * nodes are dropped from the front of the node and field buffers by
+ * advancing a head offset, so nothing is reallocated.
  */
 
 #include <vector>
 #include "GridPoint.h"
 #include "Concentration.h"
+#include "ConcentrationField.h"
 
 #ifdef ENABLE_MEMWATCH
       #include <MemWatch.h>
@@ -20,6 +31,8 @@ class Wafer
 public:
 	//initializes a 1d wafer
 	Wafer(double x, double dx, Concentration initialConcentration);
+	//initializes a 1d wafer on the given increasing node depths (um)
+	Wafer(const std::vector<double> &nodes, Concentration initialConcentration);
 
 	// //initializes a 2d wafer
 	// Wafer(double x, double dx, double y, double dy);
@@ -28,21 +41,71 @@ public:
 	// Wafer (double x, double dx, double y, double dy, double z, double dz);
 
 
+public:
+	//limits for adaptMesh
+	struct MeshAdaptation
+	{
+		//largest allowed change of ln(concentration) across one interval
+		double tolerance;
+		double minDx;
+		double maxDx;
+		//concentrations (cm^-3) below this are not resolved
+		double floor;
+	};
+
+public:
+	/* node depths starting at surfaceDx and growing geometrically by growth
+	 * per interval up to maxDx, ending at depth x */
+	static std::vector<double> gradedNodes(
+		double x, double surfaceDx, double maxDx, double growth
+	);
+
+	/* refines intervals that the profile changes steeply across and removes
+	 * nodes where it is nearly linear.  Every species keeps its dose.
+	 * Returns the new number of nodes. */
+	int adaptMesh(const MeshAdaptation &limits);
+
+	/* moves the surface node deeper into the wafer (a consumed surface).
+	 * consumed, if given, receives the dose each species lost. */
+	void moveSurface(double depth, double *consumed = NULL);
+	//merges the surface node into its neighbour, which becomes the surface
+	void removeSurfaceNode();
+
+public:
+	int getNumGridPoints() const;
+	double getX() const;
+	//smallest node spacing
+	double getDx() const;
+	const double *getNodes() const;
+	double getNode(int node) const;
+	//width of the region closer to this node than to its neighbours
+	double getControlVolume(int node) const;
+	//integral of a species over depth, cm^-3 um
+	double getDose(int species) const;
+	//the returned view is invalidated when the grid is rebuilt
+	GridPoint getGridPoint(int node) const;
+	ConcentrationField &getField();
+	const ConcentrationField &getField() const;
+
 public:
 	void displayCencentrationToCOUT() const;
 	void createPlot();
 
 private:
 	void initializeGrid(Concentration baseConcentration);
+	void updateSpacing();
 
 
 private:
 	double _x;
 	double _dx;
+	std::vector<double> _nodes;
+	//index of the surface node in _nodes
+	int _nodeHead;
 	// double _y;
 	// double _dy;
 	// double _z;
 	// double _dz;
-	std::vector<GridPoint> _gridPoints;
+	ConcentrationField _field;
 
 };
\ No newline at end of file